@@ -1,4 +1,16 @@
- 
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#define CACHE_LINE_SIZE 64
+
 typedef struct {
     int *values;
     int head;
@@ -65,3 +77,788 @@ bool queue_dequeue(queue_t *p_queue, int *p_val)
     return true;
 }
 
+/*
+ * Bulk operations copy up to n values with at most two memcpy calls (one
+ * before and one after the wrap point) and update the indices once.
+ * They return how many values were actually moved, which is less than n
+ * when the queue runs full/empty.
+ */
+int queue_enqueue_bulk(queue_t *p_queue, const int *p_src, int n)
+{
+    int free_slots = p_queue->size - p_queue->num_entries;
+    int count = (n < free_slots) ? n : free_slots;
+
+    if(count <= 0)
+    {
+        return 0;
+    }
+
+    int first = p_queue->size - p_queue->tail;
+    if(first > count)
+    {
+        first = count;
+    }
+
+    memcpy(&p_queue->values[p_queue->tail], p_src, sizeof(int) * first);
+    memcpy(p_queue->values, p_src + first, sizeof(int) * (count - first));
+
+    p_queue->tail += count;
+    if(p_queue->tail >= p_queue->size)
+    {
+        p_queue->tail -= p_queue->size;
+    }
+    p_queue->num_entries += count;
+
+    return count;
+}
+
+int queue_dequeue_bulk(queue_t *p_queue, int *p_dst, int n)
+{
+    int count = (n < p_queue->num_entries) ? n : p_queue->num_entries;
+
+    if(count <= 0)
+    {
+        return 0;
+    }
+
+    int first = p_queue->size - p_queue->head;
+    if(first > count)
+    {
+        first = count;
+    }
+
+    memcpy(p_dst, &p_queue->values[p_queue->head], sizeof(int) * first);
+    memcpy(p_dst + first, p_queue->values, sizeof(int) * (count - first));
+
+    p_queue->head += count;
+    if(p_queue->head >= p_queue->size)
+    {
+        p_queue->head -= p_queue->size;
+    }
+    p_queue->num_entries -= count;
+
+    return count;
+}
+
+// Smallest power of two that is >= n (n must be non-zero)
+static size_t round_up_pow2(size_t n)
+{
+    size_t pow2 = 1;
+
+    while(pow2 < n)
+    {
+        pow2 <<= 1;
+    }
+
+    return pow2;
+}
+
+/*
+ * Power-of-two capacity queue.
+ *
+ * head and tail are free-running counters that are never wrapped, the slot
+ * index is (counter & mask) and the number of entries is (tail - head).
+ * Unsigned subtraction keeps that correct when the counters overflow, so
+ * there is no division and no num_entries to keep in sync.
+ */
+typedef struct {
+    int *values;
+    uint32_t head;
+    uint32_t tail;
+    uint32_t mask;
+}pow2_queue_t;
+
+// Capacity is rounded up to the next power of two
+bool init_pow2_queue(pow2_queue_t *p_queue, uint32_t min_size)
+{
+    if(min_size == 0 || min_size > (UINT32_C(1) << 31))
+    {
+        return false;
+    }
+
+    uint32_t size = (uint32_t)round_up_pow2(min_size);
+
+    p_queue->values = malloc(sizeof(int) * size);
+
+    if(!p_queue->values)
+    {
+        return false;
+    }
+
+    p_queue->mask = size - 1;
+    p_queue->head = 0;
+    p_queue->tail = 0;
+
+    return true;
+}
+
+void pow2_queue_deinit(pow2_queue_t *p_queue)
+{
+    free(p_queue->values);
+    p_queue->values = NULL;
+    p_queue->mask = 0;
+    p_queue->head = 0;
+    p_queue->tail = 0;
+}
+
+static inline uint32_t pow2_queue_num_entries(const pow2_queue_t *p_queue)
+{
+    return p_queue->tail - p_queue->head;
+}
+
+static inline uint32_t pow2_queue_size(const pow2_queue_t *p_queue)
+{
+    return p_queue->mask + 1;
+}
+
+bool is_pow2_queue_empty(const pow2_queue_t *p_queue)
+{
+    return (p_queue->tail == p_queue->head);
+}
+
+bool is_pow2_queue_full(const pow2_queue_t *p_queue)
+{
+    return (pow2_queue_num_entries(p_queue) == pow2_queue_size(p_queue));
+}
+
+bool pow2_queue_enqueue(pow2_queue_t *p_queue, int value)
+{
+    // If it is full, return false
+    if(is_pow2_queue_full(p_queue))
+    {
+        return false;
+    }
+
+    p_queue->values[p_queue->tail & p_queue->mask] = value;
+    p_queue->tail++;
+
+    return true;
+}
+
+bool pow2_queue_dequeue(pow2_queue_t *p_queue, int *p_val)
+{
+    // If it is empty, return false
+    if(is_pow2_queue_empty(p_queue))
+    {
+        return false;
+    }
+
+    *p_val = p_queue->values[p_queue->head & p_queue->mask];
+    p_queue->head++;
+
+    return true;
+}
+
+uint32_t pow2_queue_enqueue_bulk(pow2_queue_t *p_queue, const int *p_src, uint32_t n)
+{
+    uint32_t free_slots = pow2_queue_size(p_queue) - pow2_queue_num_entries(p_queue);
+    uint32_t count = (n < free_slots) ? n : free_slots;
+    uint32_t idx = p_queue->tail & p_queue->mask;
+    uint32_t first = pow2_queue_size(p_queue) - idx;
+
+    if(first > count)
+    {
+        first = count;
+    }
+
+    memcpy(&p_queue->values[idx], p_src, sizeof(int) * first);
+    memcpy(p_queue->values, p_src + first, sizeof(int) * (count - first));
+    p_queue->tail += count;
+
+    return count;
+}
+
+uint32_t pow2_queue_dequeue_bulk(pow2_queue_t *p_queue, int *p_dst, uint32_t n)
+{
+    uint32_t entries = pow2_queue_num_entries(p_queue);
+    uint32_t count = (n < entries) ? n : entries;
+    uint32_t idx = p_queue->head & p_queue->mask;
+    uint32_t first = pow2_queue_size(p_queue) - idx;
+
+    if(first > count)
+    {
+        first = count;
+    }
+
+    memcpy(p_dst, &p_queue->values[idx], sizeof(int) * first);
+    memcpy(p_dst + first, p_queue->values, sizeof(int) * (count - first));
+    p_queue->head += count;
+
+    return count;
+}
+
+/*
+ * Lock-free single-producer / single-consumer queue.
+ *
+ * head is only written by the consumer and tail only by the producer, so there
+ * is no shared num_entries to fight over. Both counters run freely and the
+ * number of entries is (tail - head). Each side keeps a cached copy of the
+ * other side's counter and only reloads it when the ring looks full/empty.
+ * Capacity is rounded up to a power of two so indexing is a mask.
+ */
+typedef struct {
+    int *values;
+    size_t size;
+    size_t mask;
+
+    _Alignas(CACHE_LINE_SIZE) atomic_size_t head;
+    size_t cached_tail;
+
+    _Alignas(CACHE_LINE_SIZE) atomic_size_t tail;
+    size_t cached_head;
+}spsc_queue_t;
+
+bool init_spsc_queue(spsc_queue_t *p_queue, size_t max_size)
+{
+    if(max_size == 0)
+    {
+        return false;
+    }
+
+    size_t size = round_up_pow2(max_size);
+
+    p_queue->values = malloc(sizeof(int) * size);
+
+    if(!p_queue->values)
+    {
+        return false;
+    }
+
+    p_queue->size = size;
+    p_queue->mask = size - 1;
+    atomic_init(&p_queue->head, 0);
+    atomic_init(&p_queue->tail, 0);
+    p_queue->cached_head = 0;
+    p_queue->cached_tail = 0;
+
+    return true;
+}
+
+void spsc_queue_deinit(spsc_queue_t *p_queue)
+{
+    free(p_queue->values);
+    p_queue->values = NULL;
+    p_queue->size = 0;
+    p_queue->mask = 0;
+    atomic_store_explicit(&p_queue->head, 0, memory_order_relaxed);
+    atomic_store_explicit(&p_queue->tail, 0, memory_order_relaxed);
+    p_queue->cached_head = 0;
+    p_queue->cached_tail = 0;
+}
+
+// Must only be called from the producer thread
+bool spsc_queue_enqueue(spsc_queue_t *p_queue, int value)
+{
+    size_t tail = atomic_load_explicit(&p_queue->tail, memory_order_relaxed);
+
+    // If it looks full, refresh our view of the consumer before giving up
+    if(tail - p_queue->cached_head == p_queue->size)
+    {
+        p_queue->cached_head = atomic_load_explicit(&p_queue->head, memory_order_acquire);
+
+        if(tail - p_queue->cached_head == p_queue->size)
+        {
+            return false;
+        }
+    }
+
+    p_queue->values[tail & p_queue->mask] = value;
+
+    // Publish the slot to the consumer
+    atomic_store_explicit(&p_queue->tail, tail + 1, memory_order_release);
+
+    return true;
+}
+
+// Must only be called from the consumer thread
+bool spsc_queue_dequeue(spsc_queue_t *p_queue, int *p_val)
+{
+    size_t head = atomic_load_explicit(&p_queue->head, memory_order_relaxed);
+
+    // If it looks empty, refresh our view of the producer before giving up
+    if(head == p_queue->cached_tail)
+    {
+        p_queue->cached_tail = atomic_load_explicit(&p_queue->tail, memory_order_acquire);
+
+        if(head == p_queue->cached_tail)
+        {
+            return false;
+        }
+    }
+
+    *p_val = p_queue->values[head & p_queue->mask];
+
+    // Hand the slot back to the producer
+    atomic_store_explicit(&p_queue->head, head + 1, memory_order_release);
+
+    return true;
+}
+
+// Must only be called from the producer thread. The whole span is published
+// to the consumer with a single release store.
+size_t spsc_queue_enqueue_bulk(spsc_queue_t *p_queue, const int *p_src, size_t n)
+{
+    size_t tail = atomic_load_explicit(&p_queue->tail, memory_order_relaxed);
+    size_t free_slots = p_queue->size - (tail - p_queue->cached_head);
+
+    if(free_slots < n)
+    {
+        p_queue->cached_head = atomic_load_explicit(&p_queue->head, memory_order_acquire);
+        free_slots = p_queue->size - (tail - p_queue->cached_head);
+    }
+
+    size_t count = (n < free_slots) ? n : free_slots;
+    size_t idx = tail & p_queue->mask;
+    size_t first = p_queue->size - idx;
+
+    if(first > count)
+    {
+        first = count;
+    }
+
+    memcpy(&p_queue->values[idx], p_src, sizeof(int) * first);
+    memcpy(p_queue->values, p_src + first, sizeof(int) * (count - first));
+
+    atomic_store_explicit(&p_queue->tail, tail + count, memory_order_release);
+
+    return count;
+}
+
+// Must only be called from the consumer thread. The whole span is handed
+// back to the producer with a single release store.
+size_t spsc_queue_dequeue_bulk(spsc_queue_t *p_queue, int *p_dst, size_t n)
+{
+    size_t head = atomic_load_explicit(&p_queue->head, memory_order_relaxed);
+    size_t entries = p_queue->cached_tail - head;
+
+    if(entries < n)
+    {
+        p_queue->cached_tail = atomic_load_explicit(&p_queue->tail, memory_order_acquire);
+        entries = p_queue->cached_tail - head;
+    }
+
+    size_t count = (n < entries) ? n : entries;
+    size_t idx = head & p_queue->mask;
+    size_t first = p_queue->size - idx;
+
+    if(first > count)
+    {
+        first = count;
+    }
+
+    memcpy(p_dst, &p_queue->values[idx], sizeof(int) * first);
+    memcpy(p_dst + first, p_queue->values, sizeof(int) * (count - first));
+
+    atomic_store_explicit(&p_queue->head, head + count, memory_order_release);
+
+    return count;
+}
+
+/*
+ * Bounded lock-free multi-producer / multi-consumer queue.
+ *
+ * Every slot carries a sequence number telling whose turn it is:
+ *   seq == pos      -> free, a producer at position pos may write it
+ *   seq == pos + 1  -> full, a consumer at position pos may read it
+ * Producers and consumers claim positions with a CAS on tail/head and then
+ * publish the slot by bumping its sequence. Capacity is rounded up to a
+ * power of two so indexing is a mask.
+ */
+typedef struct {
+    atomic_size_t seq;
+    int value;
+}mpmc_slot_t;
+
+typedef struct {
+    mpmc_slot_t *slots;
+    size_t size;
+    size_t mask;
+
+    _Alignas(CACHE_LINE_SIZE) atomic_size_t head;
+    _Alignas(CACHE_LINE_SIZE) atomic_size_t tail;
+}mpmc_queue_t;
+
+bool init_mpmc_queue(mpmc_queue_t *p_queue, size_t max_size)
+{
+    if(max_size == 0)
+    {
+        return false;
+    }
+
+    size_t size = round_up_pow2(max_size);
+
+    p_queue->slots = malloc(sizeof(mpmc_slot_t) * size);
+
+    if(!p_queue->slots)
+    {
+        return false;
+    }
+
+    for(size_t i = 0; i < size; i++)
+    {
+        atomic_init(&p_queue->slots[i].seq, i);
+    }
+
+    p_queue->size = size;
+    p_queue->mask = size - 1;
+    atomic_init(&p_queue->head, 0);
+    atomic_init(&p_queue->tail, 0);
+
+    return true;
+}
+
+void mpmc_queue_deinit(mpmc_queue_t *p_queue)
+{
+    free(p_queue->slots);
+    p_queue->slots = NULL;
+    p_queue->size = 0;
+    p_queue->mask = 0;
+    atomic_store_explicit(&p_queue->head, 0, memory_order_relaxed);
+    atomic_store_explicit(&p_queue->tail, 0, memory_order_relaxed);
+}
+
+bool mpmc_queue_enqueue(mpmc_queue_t *p_queue, int value)
+{
+    size_t pos = atomic_load_explicit(&p_queue->tail, memory_order_relaxed);
+    mpmc_slot_t *p_slot;
+
+    while(true)
+    {
+        p_slot = &p_queue->slots[pos & p_queue->mask];
+        size_t seq = atomic_load_explicit(&p_slot->seq, memory_order_acquire);
+        ptrdiff_t diff = (ptrdiff_t)(seq - pos);
+
+        if(diff == 0)
+        {
+            // Slot is free, try to claim this position
+            if(atomic_compare_exchange_weak_explicit(&p_queue->tail, &pos, pos + 1,
+                                                     memory_order_relaxed, memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if(diff < 0)
+        {
+            // Slot still holds the value from the previous lap, queue is full
+            return false;
+        }
+        else
+        {
+            // Another producer got here first, catch up
+            pos = atomic_load_explicit(&p_queue->tail, memory_order_relaxed);
+        }
+    }
+
+    p_slot->value = value;
+    atomic_store_explicit(&p_slot->seq, pos + 1, memory_order_release);
+
+    return true;
+}
+
+bool mpmc_queue_dequeue(mpmc_queue_t *p_queue, int *p_val)
+{
+    size_t pos = atomic_load_explicit(&p_queue->head, memory_order_relaxed);
+    mpmc_slot_t *p_slot;
+
+    while(true)
+    {
+        p_slot = &p_queue->slots[pos & p_queue->mask];
+        size_t seq = atomic_load_explicit(&p_slot->seq, memory_order_acquire);
+        ptrdiff_t diff = (ptrdiff_t)(seq - (pos + 1));
+
+        if(diff == 0)
+        {
+            // Slot is full, try to claim this position
+            if(atomic_compare_exchange_weak_explicit(&p_queue->head, &pos, pos + 1,
+                                                     memory_order_relaxed, memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if(diff < 0)
+        {
+            // Nothing has been published here yet, queue is empty
+            return false;
+        }
+        else
+        {
+            // Another consumer got here first, catch up
+            pos = atomic_load_explicit(&p_queue->head, memory_order_relaxed);
+        }
+    }
+
+    *p_val = p_slot->value;
+
+    // Free the slot for the producer one lap ahead
+    atomic_store_explicit(&p_slot->seq, pos + p_queue->size, memory_order_release);
+
+    return true;
+}
+
+/*
+ * Element-size-aware queue.
+ *
+ * Stores records of any size inline in the ring instead of int values, so
+ * a struct can be queued without a side table. Slots are elem_size rounded
+ * up to max_align_t, so a pointer to a slot can be used as the record type.
+ *
+ * Same threading rules and counters as spsc_queue_t: one producer and one
+ * consumer thread, free-running head/tail and a power-of-two capacity.
+ *
+ * Besides copying enqueue/dequeue there is a zero-copy API:
+ *   producer: elem_queue_reserve() -> fill the slot -> elem_queue_commit()
+ *   consumer: elem_queue_front()   -> read the slot -> elem_queue_release()
+ */
+typedef struct {
+    unsigned char *buffer;
+    size_t elem_size;
+    size_t stride;
+    size_t size;
+    size_t mask;
+
+    _Alignas(CACHE_LINE_SIZE) atomic_size_t head;
+    size_t cached_tail;
+
+    _Alignas(CACHE_LINE_SIZE) atomic_size_t tail;
+    size_t cached_head;
+}elem_queue_t;
+
+bool init_elem_queue(elem_queue_t *p_queue, size_t elem_size, size_t max_size)
+{
+    if(elem_size == 0 || max_size == 0)
+    {
+        return false;
+    }
+
+    size_t align = _Alignof(max_align_t);
+    size_t stride = (elem_size + align - 1) & ~(align - 1);
+    size_t size = round_up_pow2(max_size);
+
+    p_queue->buffer = malloc(stride * size);
+
+    if(!p_queue->buffer)
+    {
+        return false;
+    }
+
+    p_queue->elem_size = elem_size;
+    p_queue->stride = stride;
+    p_queue->size = size;
+    p_queue->mask = size - 1;
+    atomic_init(&p_queue->head, 0);
+    atomic_init(&p_queue->tail, 0);
+    p_queue->cached_head = 0;
+    p_queue->cached_tail = 0;
+
+    return true;
+}
+
+void elem_queue_deinit(elem_queue_t *p_queue)
+{
+    free(p_queue->buffer);
+    p_queue->buffer = NULL;
+    p_queue->elem_size = 0;
+    p_queue->stride = 0;
+    p_queue->size = 0;
+    p_queue->mask = 0;
+    atomic_store_explicit(&p_queue->head, 0, memory_order_relaxed);
+    atomic_store_explicit(&p_queue->tail, 0, memory_order_relaxed);
+    p_queue->cached_head = 0;
+    p_queue->cached_tail = 0;
+}
+
+static inline void *elem_queue_slot(const elem_queue_t *p_queue, size_t pos)
+{
+    return p_queue->buffer + (pos & p_queue->mask) * p_queue->stride;
+}
+
+// Producer: returns the next free slot or NULL if the queue is full. The slot
+// is not visible to the consumer until elem_queue_commit() is called.
+void *elem_queue_reserve(elem_queue_t *p_queue)
+{
+    size_t tail = atomic_load_explicit(&p_queue->tail, memory_order_relaxed);
+
+    if(tail - p_queue->cached_head == p_queue->size)
+    {
+        p_queue->cached_head = atomic_load_explicit(&p_queue->head, memory_order_acquire);
+
+        if(tail - p_queue->cached_head == p_queue->size)
+        {
+            return NULL;
+        }
+    }
+
+    return elem_queue_slot(p_queue, tail);
+}
+
+// Producer: publishes the slot returned by the last elem_queue_reserve()
+void elem_queue_commit(elem_queue_t *p_queue)
+{
+    size_t tail = atomic_load_explicit(&p_queue->tail, memory_order_relaxed);
+
+    atomic_store_explicit(&p_queue->tail, tail + 1, memory_order_release);
+}
+
+// Consumer: returns the oldest slot or NULL if the queue is empty. The slot
+// stays owned by the consumer until elem_queue_release() is called.
+void *elem_queue_front(elem_queue_t *p_queue)
+{
+    size_t head = atomic_load_explicit(&p_queue->head, memory_order_relaxed);
+
+    if(head == p_queue->cached_tail)
+    {
+        p_queue->cached_tail = atomic_load_explicit(&p_queue->tail, memory_order_acquire);
+
+        if(head == p_queue->cached_tail)
+        {
+            return NULL;
+        }
+    }
+
+    return elem_queue_slot(p_queue, head);
+}
+
+// Consumer: hands the slot returned by the last elem_queue_front() back
+void elem_queue_release(elem_queue_t *p_queue)
+{
+    size_t head = atomic_load_explicit(&p_queue->head, memory_order_relaxed);
+
+    atomic_store_explicit(&p_queue->head, head + 1, memory_order_release);
+}
+
+bool elem_queue_enqueue(elem_queue_t *p_queue, const void *p_elem)
+{
+    void *p_slot = elem_queue_reserve(p_queue);
+
+    // If it is full, return false
+    if(!p_slot)
+    {
+        return false;
+    }
+
+    memcpy(p_slot, p_elem, p_queue->elem_size);
+    elem_queue_commit(p_queue);
+
+    return true;
+}
+
+bool elem_queue_dequeue(elem_queue_t *p_queue, void *p_elem)
+{
+    const void *p_slot = elem_queue_front(p_queue);
+
+    // If it is empty, return false
+    if(!p_slot)
+    {
+        return false;
+    }
+
+    memcpy(p_elem, p_slot, p_queue->elem_size);
+    elem_queue_release(p_queue);
+
+    return true;
+}
+
+/*
+ * Micro-benchmark: modulo queue_t vs. pow2_queue_t.
+ *
+ * Each round fills the queue to half of its capacity and drains it again, so
+ * head/tail keep wrapping. Reported numbers are enqueue+dequeue ops per
+ * second. Build with optimizations, e.g. gcc -O2 circular_queue.c
+ */
+#define BENCH_TOTAL_OPS 50000000
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double bench_modulo_queue(int capacity, long *p_checksum)
+{
+    queue_t queue;
+    int burst = capacity / 2 ? capacity / 2 : 1;
+    long rounds = BENCH_TOTAL_OPS / (2L * burst);
+    long sum = 0;
+    int val = 0;
+
+    init_queue(&queue, capacity);
+
+    double start = now_sec();
+    for(long r = 0; r < rounds; r++)
+    {
+        for(int i = 0; i < burst; i++)
+        {
+            queue_enqueue(&queue, i);
+        }
+
+        for(int i = 0; i < burst; i++)
+        {
+            queue_dequeue(&queue, &val);
+            sum += val;
+        }
+    }
+    double elapsed = now_sec() - start;
+
+    queue_deinit(&queue);
+    *p_checksum += sum;
+
+    return (2.0 * rounds * burst) / elapsed;
+}
+
+static double bench_pow2_queue(int capacity, long *p_checksum)
+{
+    pow2_queue_t queue;
+    int burst = capacity / 2 ? capacity / 2 : 1;
+    long rounds = BENCH_TOTAL_OPS / (2L * burst);
+    long sum = 0;
+    int val = 0;
+
+    if(!init_pow2_queue(&queue, capacity))
+    {
+        return 0.0;
+    }
+
+    double start = now_sec();
+    for(long r = 0; r < rounds; r++)
+    {
+        for(int i = 0; i < burst; i++)
+        {
+            pow2_queue_enqueue(&queue, i);
+        }
+
+        for(int i = 0; i < burst; i++)
+        {
+            pow2_queue_dequeue(&queue, &val);
+            sum += val;
+        }
+    }
+    double elapsed = now_sec() - start;
+
+    pow2_queue_deinit(&queue);
+    *p_checksum += sum;
+
+    return (2.0 * rounds * burst) / elapsed;
+}
+
+int main(void)
+{
+    const int capacities[] = {16, 100, 1000, 4096, 65536, 1 << 20};
+    long checksum = 0;
+
+    printf("%10s %16s %16s %8s\n", "capacity", "modulo ops/s", "pow2 ops/s", "speedup");
+
+    for(size_t i = 0; i < sizeof(capacities) / sizeof(capacities[0]); i++)
+    {
+        double mod_ops = bench_modulo_queue(capacities[i], &checksum);
+        double pow2_ops = bench_pow2_queue(capacities[i], &checksum);
+
+        printf("%10d %16.0f %16.0f %7.2fx\n", capacities[i], mod_ops, pow2_ops, pow2_ops / mod_ops);
+    }
+
+    // Keeps the compiler from dropping the dequeued values
+    printf("checksum: %ld\n", checksum);
+
+    return 0;
+}
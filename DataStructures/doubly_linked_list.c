@@ -13,6 +13,13 @@
  *   - Push elements to the head or tail
  *   - Pop elements from the head or tail
  *   - Print contents for debugging
+ *   - Optionally take nodes from a per-list pool (@ref list_init_pooled)
+ *
+ * An unrolled variant (@ref UnrolledList) stores a cache line's worth of
+ * values per node, for lists that are mostly traversed.
+ *
+ * An intrusive variant (@ref IntrusiveList) links caller-owned objects
+ * through an embedded @ref ListLink, with no allocation at all.
  *
  * Example usage:
  * @code
@@ -34,12 +41,18 @@
  *
  * @note This implementation uses dynamic memory allocation (`malloc`/`free`).
  *       Always deinitialize the list with @ref list_deinit to prevent leaks.
+ *
+ * @note A pooled list allocates nodes in chunks and recycles popped nodes
+ *       through a free-list, so steady push/pop churn makes no allocator
+ *       calls. @ref list_deinit then frees whole chunks instead of nodes.
  */
 
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 typedef struct Node {
     int data;
@@ -47,10 +60,22 @@ typedef struct Node {
     struct Node *prev;
 }Node;
 
+/* Backing storage of a node pool, nodes are handed out front to back */
+typedef struct NodeChunk {
+    struct NodeChunk *next;
+    size_t used;
+    Node nodes[];
+} NodeChunk;
+
 typedef struct {
     Node *head;
     Node *tail;
     size_t size;
+
+    /* Node pool, only used when chunk_size != 0 */
+    size_t chunk_size;
+    NodeChunk *chunks;
+    Node *free_nodes;   /* Recycled nodes, linked through next */
 } LinkedList;
 
 void list_init(LinkedList *list)
@@ -58,11 +83,64 @@ void list_init(LinkedList *list)
     list->head = NULL;
     list->tail = NULL;
     list->size = 0;
+    list->chunk_size = 0;
+    list->chunks = NULL;
+    list->free_nodes = NULL;
+}
+
+/* Initialize a list that allocates nodes chunk_size at a time */
+void list_init_pooled(LinkedList *list, size_t chunk_size)
+{
+    list_init(list);
+    list->chunk_size = chunk_size;
+}
+
+static Node *node_alloc(LinkedList *list)
+{
+    if(!list->chunk_size)
+    {
+        return malloc(sizeof(Node));
+    }
+
+    if(list->free_nodes)
+    {
+        Node *node = list->free_nodes;
+        list->free_nodes = node->next;
+        return node;
+    }
+
+    if(!list->chunks || list->chunks->used == list->chunk_size)
+    {
+        NodeChunk *chunk = malloc(sizeof(NodeChunk) + sizeof(Node) * list->chunk_size);
+
+        if(!chunk)
+        {
+            return NULL;
+        }
+
+        chunk->next = list->chunks;
+        chunk->used = 0;
+        list->chunks = chunk;
+    }
+
+    return &list->chunks->nodes[list->chunks->used++];
+}
+
+static void node_free(LinkedList *list, Node *node)
+{
+    if(!list->chunk_size)
+    {
+        free(node);
+        return;
+    }
+
+    node->next = list->free_nodes;
+    list->free_nodes = node;
 }
 
 void list_push_head(LinkedList *list, int value)
 {
-    Node *new_node = malloc(sizeof(Node));
+    Node *new_node = node_alloc(list);
     
     if(!new_node)
     {
@@ -88,7 +166,7 @@ void list_push_head(LinkedList *list, int value)
 
 void list_push_tail(LinkedList *list, int value)
 {
-    Node *new_node = malloc(sizeof(Node));
+    Node *new_node = node_alloc(list);
     
     if(!new_node)
     {
@@ -133,7 +211,7 @@ bool list_pop_head(LinkedList *list, int *out_value)
     }
     
     
-    free(temp_node);
+    node_free(list, temp_node);
     list->size--;
     
     return true;
@@ -160,7 +238,7 @@ bool list_pop_tail(LinkedList *list, int *out_value)
         list->head = NULL;
     }
     
-    free(temp);
+    node_free(list, temp);
     list->size--;
     
     return true;
@@ -178,19 +256,407 @@ void list_print(const LinkedList *list)
     printf("\n");
 }
 
-/* Free all nodes */
+/* Free all nodes, a pooled list frees whole chunks */
 void list_deinit(LinkedList *list)
 {
-    Node *cur = list->head;
-    while (cur) {
-        Node *next = cur->next;
-        free(cur);
-        cur = next;
+    if (list->chunk_size) {
+        NodeChunk *chunk = list->chunks;
+        while (chunk) {
+            NodeChunk *next = chunk->next;
+            free(chunk);
+            chunk = next;
+        }
+        list->chunks = NULL;
+        list->free_nodes = NULL;
+    } else {
+        Node *cur = list->head;
+        while (cur) {
+            Node *next = cur->next;
+            free(cur);
+            cur = next;
+        }
     }
     list->head = list->tail = NULL;
     list->size = 0;
 }
 
+/*
+ * Unrolled list
+ *
+ * Each node is one cache line holding up to UNROLLED_NODE_VALUES values in
+ * values[start .. start + count). Only the end nodes are ever partially
+ * filled: pushes to the head grow leftwards, pushes to the tail grow
+ * rightwards, and a fresh node starts in the middle so it can grow both
+ * ways. Traversal is a sequential walk over each node's array.
+ *
+ * One emptied node is kept as a spare so push/pop churn across a node
+ * boundary does not call malloc/free every time.
+ */
+#define UNROLLED_NODE_SIZE 64
+#define UNROLLED_NODE_VALUES \
+    ((UNROLLED_NODE_SIZE - 2 * sizeof(void *) - 2 * sizeof(uint16_t)) / sizeof(int))
+
+typedef struct UnrolledNode {
+    struct UnrolledNode *next;
+    struct UnrolledNode *prev;
+    uint16_t start;
+    uint16_t count;
+    int values[UNROLLED_NODE_VALUES];
+} UnrolledNode;
+
+typedef struct {
+    UnrolledNode *head;
+    UnrolledNode *tail;
+    UnrolledNode *spare;
+    size_t size;
+} UnrolledList;
+
+void unrolled_list_init(UnrolledList *list)
+{
+    list->head = NULL;
+    list->tail = NULL;
+    list->spare = NULL;
+    list->size = 0;
+}
+
+static UnrolledNode *unrolled_node_alloc(UnrolledList *list, uint16_t start)
+{
+    UnrolledNode *node = list->spare;
+
+    if(node)
+    {
+        list->spare = NULL;
+    }
+    else
+    {
+        node = aligned_alloc(UNROLLED_NODE_SIZE, sizeof(UnrolledNode));
+
+        if(!node)
+        {
+            return NULL;
+        }
+    }
+
+    node->next = NULL;
+    node->prev = NULL;
+    node->start = start;
+    node->count = 0;
+
+    return node;
+}
+
+static void unrolled_node_unlink(UnrolledList *list, UnrolledNode *node)
+{
+    if(node->prev)
+    {
+        node->prev->next = node->next;
+    }
+    else
+    {
+        list->head = node->next;
+    }
+
+    if(node->next)
+    {
+        node->next->prev = node->prev;
+    }
+    else
+    {
+        list->tail = node->prev;
+    }
+
+    if(list->spare)
+    {
+        free(node);
+    }
+    else
+    {
+        list->spare = node;
+    }
+}
+
+bool unrolled_list_push_head(UnrolledList *list, int value)
+{
+    UnrolledNode *node = list->head;
+
+    if(!node || node->start == 0)
+    {
+        /* A new head node fills from its end, except the very first node */
+        uint16_t start = node ? UNROLLED_NODE_VALUES : UNROLLED_NODE_VALUES / 2;
+        UnrolledNode *new_node = unrolled_node_alloc(list, start);
+
+        if(!new_node)
+        {
+            return false;
+        }
+
+        new_node->next = node;
+        if(node)
+        {
+            node->prev = new_node;
+        }
+        else
+        {
+            list->tail = new_node;
+        }
+
+        list->head = new_node;
+        node = new_node;
+    }
+
+    node->values[--node->start] = value;
+    node->count++;
+    list->size++;
+
+    return true;
+}
+
+bool unrolled_list_push_tail(UnrolledList *list, int value)
+{
+    UnrolledNode *node = list->tail;
+
+    if(!node || node->start + node->count == UNROLLED_NODE_VALUES)
+    {
+        /* A new tail node fills from its beginning, except the very first node */
+        uint16_t start = node ? 0 : UNROLLED_NODE_VALUES / 2;
+        UnrolledNode *new_node = unrolled_node_alloc(list, start);
+
+        if(!new_node)
+        {
+            return false;
+        }
+
+        new_node->prev = node;
+        if(node)
+        {
+            node->next = new_node;
+        }
+        else
+        {
+            list->head = new_node;
+        }
+
+        list->tail = new_node;
+        node = new_node;
+    }
+
+    node->values[node->start + node->count] = value;
+    node->count++;
+    list->size++;
+
+    return true;
+}
+
+bool unrolled_list_pop_head(UnrolledList *list, int *out_value)
+{
+    UnrolledNode *node = list->head;
+
+    if(!node)
+    {
+        return false;
+    }
+
+    *out_value = node->values[node->start++];
+    node->count--;
+    list->size--;
+
+    if(!node->count)
+    {
+        unrolled_node_unlink(list, node);
+    }
+
+    return true;
+}
+
+bool unrolled_list_pop_tail(UnrolledList *list, int *out_value)
+{
+    UnrolledNode *node = list->tail;
+
+    if(!node)
+    {
+        return false;
+    }
+
+    *out_value = node->values[node->start + node->count - 1];
+    node->count--;
+    list->size--;
+
+    if(!node->count)
+    {
+        unrolled_node_unlink(list, node);
+    }
+
+    return true;
+}
+
+/* Print list from head to tail */
+void unrolled_list_print(const UnrolledList *list)
+{
+    const UnrolledNode *node = list->head;
+    printf("Unrolled list (%zu): ", list->size);
+    while (node) {
+        for (uint16_t i = node->start; i < node->start + node->count; i++) {
+            printf("%d ", node->values[i]);
+        }
+        node = node->next;
+    }
+    printf("\n");
+}
+
+/* Free all nodes */
+void unrolled_list_deinit(UnrolledList *list)
+{
+    UnrolledNode *node = list->head;
+    while (node) {
+        UnrolledNode *next = node->next;
+        free(node);
+        node = next;
+    }
+    free(list->spare);
+    list->head = list->tail = list->spare = NULL;
+    list->size = 0;
+}
+
+/*
+ * Intrusive list
+ *
+ * Objects embed a ListLink and are put on lists directly, container_of()
+ * gets the object back from its link. The list is circular around a
+ * sentinel, so unlink, move and splice are O(1) and need no list pointer
+ * or NULL checks. An unlinked ListLink points to itself.
+ *
+ * The list never allocates or frees: the caller owns the objects and must
+ * unlink them before freeing.
+ */
+#define container_of(ptr, type, member) \
+    ((type *)((char *)(ptr) - offsetof(type, member)))
+
+typedef struct ListLink {
+    struct ListLink *next;
+    struct ListLink *prev;
+} ListLink;
+
+typedef struct {
+    ListLink sentinel;
+} IntrusiveList;
+
+/* Iterate over every link; don't unlink pos inside the loop body */
+#define ilist_for_each(pos, list) \
+    for ((pos) = (list)->sentinel.next; (pos) != &(list)->sentinel; (pos) = (pos)->next)
+
+void ilink_init(ListLink *link)
+{
+    link->next = link;
+    link->prev = link;
+}
+
+bool ilink_is_linked(const ListLink *link)
+{
+    return link->next != link;
+}
+
+void ilist_init(IntrusiveList *list)
+{
+    ilink_init(&list->sentinel);
+}
+
+bool ilist_is_empty(const IntrusiveList *list)
+{
+    return list->sentinel.next == &list->sentinel;
+}
+
+static void ilink_insert_between(ListLink *link, ListLink *prev, ListLink *next)
+{
+    link->prev = prev;
+    link->next = next;
+    prev->next = link;
+    next->prev = link;
+}
+
+void ilist_push_head(IntrusiveList *list, ListLink *link)
+{
+    ilink_insert_between(link, &list->sentinel, list->sentinel.next);
+}
+
+void ilist_push_tail(IntrusiveList *list, ListLink *link)
+{
+    ilink_insert_between(link, list->sentinel.prev, &list->sentinel);
+}
+
+/* Remove link from whatever list it is on */
+void ilist_unlink(ListLink *link)
+{
+    link->prev->next = link->next;
+    link->next->prev = link->prev;
+    ilink_init(link);
+}
+
+ListLink *ilist_first(const IntrusiveList *list)
+{
+    return ilist_is_empty(list) ? NULL : list->sentinel.next;
+}
+
+ListLink *ilist_last(const IntrusiveList *list)
+{
+    return ilist_is_empty(list) ? NULL : list->sentinel.prev;
+}
+
+ListLink *ilist_pop_head(IntrusiveList *list)
+{
+    ListLink *link = ilist_first(list);
+
+    if(link)
+    {
+        ilist_unlink(link);
+    }
+
+    return link;
+}
+
+ListLink *ilist_pop_tail(IntrusiveList *list)
+{
+    ListLink *link = ilist_last(list);
+
+    if(link)
+    {
+        ilist_unlink(link);
+    }
+
+    return link;
+}
+
+/* Move link (on this or another list) to the head of list, e.g. LRU touch */
+void ilist_move_head(IntrusiveList *list, ListLink *link)
+{
+    ilist_unlink(link);
+    ilist_push_head(list, link);
+}
+
+void ilist_move_tail(IntrusiveList *list, ListLink *link)
+{
+    ilist_unlink(link);
+    ilist_push_tail(list, link);
+}
+
+/* Append every element of src to dst, src is left empty */
+void ilist_splice_tail(IntrusiveList *dst, IntrusiveList *src)
+{
+    if(ilist_is_empty(src))
+    {
+        return;
+    }
+
+    ListLink *first = src->sentinel.next;
+    ListLink *last = src->sentinel.prev;
+
+    first->prev = dst->sentinel.prev;
+    dst->sentinel.prev->next = first;
+    last->next = &dst->sentinel;
+    dst->sentinel.prev = last;
+
+    ilist_init(src);
+}
+
 /* Example usage */
 int main(void)
 {
@@ -211,5 +677,66 @@ int main(void)
     list_print(&list);
 
     list_deinit(&list);
+
+    /* Same usage with pooled nodes: after warm-up, push/pop never calls malloc */
+    LinkedList pooled;
+    list_init_pooled(&pooled, 64);
+
+    for (int round = 0; round < 1000; round++) {
+        list_push_tail(&pooled, round);
+        list_push_head(&pooled, -round);
+        list_pop_head(&pooled, &val);
+    }
+    printf("Pooled list size: %zu\n", pooled.size);
+
+    list_deinit(&pooled);
+
+    /* Unrolled list: values are packed UNROLLED_NODE_VALUES to a node */
+    UnrolledList unrolled;
+    unrolled_list_init(&unrolled);
+
+    for (int i = 1; i <= 20; i++) {
+        unrolled_list_push_tail(&unrolled, i);
+    }
+    unrolled_list_push_head(&unrolled, 0);
+    unrolled_list_print(&unrolled);
+
+    unrolled_list_pop_head(&unrolled, &val);
+    printf("Popped from head: %d\n", val);
+    unrolled_list_pop_tail(&unrolled, &val);
+    printf("Popped from tail: %d\n", val);
+    unrolled_list_print(&unrolled);
+
+    unrolled_list_deinit(&unrolled);
+
+    /* Intrusive list: the objects carry their own links, nothing is allocated */
+    typedef struct {
+        int id;
+        ListLink lru_link;
+    } Entry;
+
+    Entry entries[4];
+    IntrusiveList lru, evicted;
+    ListLink *pos;
+
+    ilist_init(&lru);
+    ilist_init(&evicted);
+
+    for (int i = 0; i < 4; i++) {
+        entries[i].id = i;
+        ilist_push_head(&lru, &entries[i].lru_link);
+    }
+
+    /* Touch entry 1, then evict the least recently used one */
+    ilist_move_head(&lru, &entries[1].lru_link);
+    ilist_move_tail(&evicted, ilist_last(&lru));
+
+    printf("LRU: ");
+    ilist_for_each(pos, &lru) {
+        printf("%d ", container_of(pos, Entry, lru_link)->id);
+    }
+    printf("\nEvicted: %d\n", container_of(ilist_first(&evicted), Entry, lru_link)->id);
+
+    ilist_splice_tail(&lru, &evicted);
     return 0;
 }
\ No newline at end of file
@@ -1,10 +1,15 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <time.h>
 
 #define NAME_SIZE 20
-#define TABLE_SIZE 20
+#define INITIAL_TABLE_SIZE 16   // Must be a power of two
+#define MAX_LOAD_PERCENT 70     // Grow/rehash when used slots exceed this
 
 typedef struct {
     char name[NAME_SIZE];
@@ -12,98 +17,375 @@ typedef struct {
     unsigned int height;
 } person_t;
 
-person_t *hash_table[TABLE_SIZE];
+/*
+ * Open addressing with linear probing.
+ *
+ * A slot is either NULL (never used), TOMBSTONE (deleted) or a person.
+ * Lookups stop at the first NULL slot, deletes leave a tombstone so the
+ * probe chains that run through them stay intact. Inserts reuse the first
+ * tombstone they pass. When live entries plus tombstones go over
+ * MAX_LOAD_PERCENT, the table is rehashed, doubling if it is mostly live.
+ */
+static person_t tombstone_marker;
+#define TOMBSTONE (&tombstone_marker)
+
+static person_t **hash_table = NULL;
+static unsigned int table_size = 0;
+static unsigned int table_count = 0;
+static unsigned int table_tombstones = 0;
+
+/*
+ * Word-at-a-time string hash (xxHash64 small-input path).
+ *
+ * Names are consumed 8 bytes at a time with unaligned-safe memcpy loads,
+ * then a 4 byte step and a byte tail, followed by a full avalanche so the
+ * low bits used by the table mask are well mixed. Only bytes up to the NUL
+ * are read, so shorter string literals are safe to pass.
+ */
+#define HASH_PRIME_1 0x9E3779B185EBCA87ULL
+#define HASH_PRIME_2 0xC2B2AE3D27D4EB4FULL
+#define HASH_PRIME_3 0x165667B19E3779F9ULL
+#define HASH_PRIME_4 0x85EBCA77C2B2AE63ULL
+#define HASH_PRIME_5 0x27D4EB2F165667C5ULL
 
-static unsigned int hash(const char *p_name)
+static inline uint64_t rotl64(uint64_t x, int r)
 {
-    unsigned int len = strnlen(p_name, NAME_SIZE);
-    unsigned int hash = 0;
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t read_u64(const unsigned char *p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
 
-    for(int i = 0; i < len; i++)
+static inline uint32_t read_u32(const unsigned char *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint64_t hash(const char *p_name)
+{
+    const unsigned char *p = (const unsigned char *)p_name;
+    size_t len = strnlen(p_name, NAME_SIZE);
+    uint64_t hash = HASH_PRIME_5 + len;
+
+    for(; len >= 8; len -= 8, p += 8)
     {
-        hash += p_name[i];
-        hash = (hash * p_name[i]) % TABLE_SIZE;
+        uint64_t k = rotl64(read_u64(p) * HASH_PRIME_2, 31) * HASH_PRIME_1;
+        hash = rotl64(hash ^ k, 27) * HASH_PRIME_1 + HASH_PRIME_4;
     }
 
+    if(len >= 4)
+    {
+        hash = rotl64(hash ^ (read_u32(p) * HASH_PRIME_1), 23) * HASH_PRIME_2 + HASH_PRIME_3;
+        len -= 4;
+        p += 4;
+    }
+
+    for(; len > 0; len--, p++)
+    {
+        hash = rotl64(hash ^ (*p * HASH_PRIME_5), 11) * HASH_PRIME_1;
+    }
+
+    // Avalanche
+    hash ^= hash >> 33;
+    hash *= HASH_PRIME_2;
+    hash ^= hash >> 29;
+    hash *= HASH_PRIME_3;
+    hash ^= hash >> 32;
+
     return hash;
 }
 
-void hash_table_init(void)
+static bool is_slot_used(const person_t *p_slot)
+{
+    return (p_slot != NULL && p_slot != TOMBSTONE);
+}
+
+// Returns the slot holding p_name, or -1 if it is not in the table
+static int find_slot(const char *p_name)
 {
-    for(int i = 0; i < TABLE_SIZE; i++)
+    if(table_size == 0)
     {
-        hash_table[i] = NULL;
+        return -1;
     }
+
+    unsigned int mask = table_size - 1;
+    unsigned int idx = (unsigned int)(hash(p_name) & mask);
+
+    // The load factor guarantees at least one NULL slot, so this terminates
+    while(hash_table[idx] != NULL)
+    {
+        if(hash_table[idx] != TOMBSTONE && strncmp(p_name, hash_table[idx]->name, NAME_SIZE) == 0)
+        {
+            return idx;
+        }
+
+        idx = (idx + 1) & mask;
+    }
+
+    return -1;
 }
 
-bool hash_table_insert_person(const person_t *p_person)
+static bool hash_table_rehash(unsigned int new_size)
 {
-    bool is_success = true;
-    unsigned int idx = hash(p_person->name);
+    person_t **old_table = hash_table;
+    unsigned int old_size = table_size;
+    person_t **new_table = calloc(new_size, sizeof(person_t *));
 
-    if(hash_table[idx] == NULL)
+    if(!new_table)
     {
-        hash_table[idx] = p_person;
+        return false;
     }
-    else
+
+    hash_table = new_table;
+    table_size = new_size;
+    table_tombstones = 0;
+
+    for(unsigned int i = 0; i < old_size; i++)
     {
-        is_success = false;
+        if(!is_slot_used(old_table[i]))
+        {
+            continue;
+        }
+
+        unsigned int idx = (unsigned int)(hash(old_table[i]->name) & (new_size - 1));
+
+        while(hash_table[idx] != NULL)
+        {
+            idx = (idx + 1) & (new_size - 1);
+        }
+
+        hash_table[idx] = old_table[i];
     }
 
-    return is_success;
+    free(old_table);
+
+    return true;
 }
 
-bool hash_table_delete_person(const person_t *p_person)
+bool hash_table_init(void)
+{
+    hash_table = calloc(INITIAL_TABLE_SIZE, sizeof(person_t *));
+
+    if(!hash_table)
+    {
+        table_size = 0;
+        return false;
+    }
+
+    table_size = INITIAL_TABLE_SIZE;
+    table_count = 0;
+    table_tombstones = 0;
+
+    return true;
+}
+
+void hash_table_deinit(void)
 {
-    bool is_success = true;
-    unsigned int idx = hash(p_person->name);
+    free(hash_table);
+    hash_table = NULL;
+    table_size = 0;
+    table_count = 0;
+    table_tombstones = 0;
+}
+
+// The table stores the pointer, the person must outlive its entry
+bool hash_table_insert_person(person_t *p_person)
+{
+    if(find_slot(p_person->name) >= 0)
+    {
+        // Already in the table
+        return false;
+    }
+
+    // Make room before probing so the new entry lands in the final table
+    if((table_count + table_tombstones + 1) * 100 > table_size * MAX_LOAD_PERCENT)
+    {
+        unsigned int new_size = table_size ? table_size : INITIAL_TABLE_SIZE;
+
+        // Only grow if live entries are the problem, otherwise just clear tombstones
+        if((table_count + 1) * 100 > new_size * MAX_LOAD_PERCENT / 2)
+        {
+            new_size *= 2;
+        }
+
+        if(!hash_table_rehash(new_size))
+        {
+            return false;
+        }
+    }
+
+    unsigned int mask = table_size - 1;
+    unsigned int idx = (unsigned int)(hash(p_person->name) & mask);
 
-    if(hash_table[idx] != NULL && !memcmp(hash_table[idx]->name, p_person->name, NAME_SIZE))
+    while(is_slot_used(hash_table[idx]))
     {
-        hash_table[idx] = NULL;
+        idx = (idx + 1) & mask;
     }
-    else
+
+    if(hash_table[idx] == TOMBSTONE)
     {
-        is_success = false;
+        table_tombstones--;
     }
 
-    return is_success;
+    hash_table[idx] = p_person;
+    table_count++;
+
+    return true;
+}
+
+bool hash_table_delete_person(const person_t *p_person)
+{
+    int idx = find_slot(p_person->name);
+
+    if(idx < 0)
+    {
+        return false;
+    }
+
+    hash_table[idx] = TOMBSTONE;
+    table_count--;
+    table_tombstones++;
+
+    return true;
 }
 
 person_t *hash_table_lookup(const char *p_name)
 {
-    for(int i = 0; i < TABLE_SIZE; i++)
+    int idx = find_slot(p_name);
+
+    return (idx >= 0) ? hash_table[idx] : NULL;
+}
+
+int hash_table_find(const char *p_name)
+{
+    return find_slot(p_name);
+}
+
+void hash_table_print(void)
+{
+    printf("HASH TABLE (%u/%u)\n", table_count, table_size);
+
+    for(unsigned int i = 0; i < table_size; i++)
     {
-        if(hash_table[i] && strncmp(p_name, hash_table[i]->name, NAME_SIZE) == 0)
+        if(hash_table[i] == TOMBSTONE)
+        {
+            printf("Idx: %u\t\t\t<deleted>\t\n", i);
+        }
+        else
         {
-            return hash_table[i];
+            printf("Idx: %u\t\t\tAddress:%p\t\n", i, (void *)hash_table[i]);
         }
     }
+}
+
+/*
+ * Hash quality and throughput check.
+ *
+ * The previous per-character multiply-and-modulo hash is kept here only as
+ * a baseline. Sequential names ("user0000001", ...) are the usual worst case
+ * for weak string hashes. For each hash we report the chi-squared statistic
+ * of the bucket counts divided by its degrees of freedom (about 1.0 for a
+ * uniform hash), the fullest bucket and the throughput.
+ */
+#define BENCH_KEYS 200000
+#define BENCH_BUCKETS 65536     // Must be a power of two
+#define BENCH_ROUNDS 50
+
+// Not const, so the legacy modulo stays a real division like it was in the table
+unsigned int legacy_table_size = BENCH_BUCKETS;
+
+static uint64_t legacy_hash(const char *p_name)
+{
+    unsigned int len = strnlen(p_name, NAME_SIZE);
+    unsigned int hash = 0;
 
-    return NULL;
+    for(unsigned int i = 0; i < len; i++)
+    {
+        hash += p_name[i];
+        hash = (hash * p_name[i]) % legacy_table_size;
+    }
+
+    return hash;
 }
 
-int hash_table_find(const char *p_name)
-{    
-    for(int i = 0; i < TABLE_SIZE; i++)
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void hash_report(const char *p_label, uint64_t (*hash_fn)(const char *),
+                        char (*p_keys)[NAME_SIZE], unsigned int *p_counts)
+{
+    memset(p_counts, 0, sizeof(unsigned int) * BENCH_BUCKETS);
+
+    for(int i = 0; i < BENCH_KEYS; i++)
+    {
+        p_counts[hash_fn(p_keys[i]) & (BENCH_BUCKETS - 1)]++;
+    }
+
+    double expected = (double)BENCH_KEYS / BENCH_BUCKETS;
+    double chi = 0.0;
+    unsigned int max_bucket = 0;
+
+    for(int i = 0; i < BENCH_BUCKETS; i++)
     {
-        if(hash_table[i] && strncmp(p_name, hash_table[i]->name, NAME_SIZE) == 0)
+        double diff = p_counts[i] - expected;
+        chi += diff * diff / expected;
+
+        if(p_counts[i] > max_bucket)
         {
-            return i;
+            max_bucket = p_counts[i];
         }
     }
 
-    return -1;
+    uint64_t sink = 0;
+    double start = now_sec();
+    for(int r = 0; r < BENCH_ROUNDS; r++)
+    {
+        for(int i = 0; i < BENCH_KEYS; i++)
+        {
+            sink += hash_fn(p_keys[i]);
+        }
+    }
+    double elapsed = now_sec() - start;
+
+    printf("%-8s chi2/df: %8.3f  max bucket: %5u  %7.2f Mhash/s  (sink %llu)\n",
+           p_label, chi / (BENCH_BUCKETS - 1), max_bucket,
+           (double)BENCH_KEYS * BENCH_ROUNDS / elapsed / 1e6, (unsigned long long)(sink & 0xFF));
 }
 
-void hash_table_print(void)
+void hash_benchmark(void)
 {
-    printf("HASH TABLE\n");
+    char (*p_keys)[NAME_SIZE] = malloc(sizeof(*p_keys) * BENCH_KEYS);
+    unsigned int *p_counts = malloc(sizeof(unsigned int) * BENCH_BUCKETS);
 
-    for(int i = 0; i < TABLE_SIZE; i++)
+    if(!p_keys || !p_counts)
     {
-        printf("Idx: %d\t\t\tAddress:%p\t\n", i, hash_table[i]);
+        free(p_keys);
+        free(p_counts);
+        return;
     }
+
+    for(int i = 0; i < BENCH_KEYS; i++)
+    {
+        snprintf(p_keys[i], NAME_SIZE, "user%07d", i);
+    }
+
+    printf("\n%d sequential names into %d buckets\n", BENCH_KEYS, BENCH_BUCKETS);
+    hash_report("legacy", legacy_hash, p_keys, p_counts);
+    hash_report("new", hash, p_keys, p_counts);
+
+    free(p_keys);
+    free(p_counts);
 }
 
 int main()
@@ -128,5 +410,12 @@ int main()
     hash_table_print();
     person_t *tmp = hash_table_lookup("Berkay");
     int idx = hash_table_find("Berkay");
-    printf("lookup person: %p, idx: %d\n", tmp, idx);
+    printf("lookup person: %p, idx: %d\n", (void *)tmp, idx);
+
+    hash_table_delete_person(&person1);
+    printf("lookup after delete: %p\n", (void *)hash_table_lookup("Berkay"));
+
+    hash_table_deinit();
+
+    hash_benchmark();
 }
\ No newline at end of file
@@ -1,19 +1,64 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <limits.h>
+#include <assert.h>
+
+#define SKIP_MAX_LEVEL 16           // Enough for ~4^16 nodes with p = 1/4
+#define SKIP_SEEK_THRESHOLD 32      // Cursor moves longer than this use the skip index
+
+struct node;
+
+typedef struct {
+    struct node *p_next;
+    size_t width;           // Number of nodes this link skips over
+}skip_link_t;
+
+// Upper levels (1 .. height - 1) of a node in the skip index
+typedef struct {
+    int height;
+    skip_link_t links[];    // links[level - 1]
+}skip_tower_t;
+
 typedef struct node{
     int val;
     struct node *p_next;
+    struct node *p_prev;    // Back-link, makes tail removal O(1)
+    skip_tower_t *p_tower;  // NULL unless the node has upper skip levels
 }node_t;
 
 typedef struct {
     node_t *p_head;
     node_t *p_tail;
     size_t size;
+
+    // Optional skip index for O(log n) positional access
+    bool has_skip_index;
+    int skip_levels;                        // Levels in use, level 0 is the list itself
+    skip_link_t skip_head[SKIP_MAX_LEVEL];  // Links out of the head, [0] unused
+    uint32_t skip_rng;
 }sll_t;
 
+// A position in the list, reused across positional edits so they only pay
+// for the distance from the previous position
+typedef struct {
+    sll_t *p_list;
+    node_t *p_node;         // Node at pos, NULL when pos == size
+    size_t pos;
+}sll_cursor_t;
+
 node_t *allocate_node(int val)
 {
     node_t *p_new_node = malloc(sizeof(node_t));
-    p_new_node->val = val;
-    p_new_node->next = NULL;
+
+    if(p_new_node)
+    {
+        p_new_node->val = val;
+        p_new_node->p_next = NULL;
+        p_new_node->p_prev = NULL;
+        p_new_node->p_tower = NULL;
+    }
 
     return p_new_node;
 }
@@ -21,191 +66,677 @@ node_t *allocate_node(int val)
 void free_node(node_t *p_node)
 {
     p_node->val = 0;
-    p_node->next = NULL;
+    p_node->p_next = NULL;
+    p_node->p_prev = NULL;
+    free(p_node->p_tower);
     free(p_node);
 }
 
-void list_init(sll_t *p_list, int val)
+/*
+ * Skip index
+ *
+ * An indexable skip list on top of the nodes: level 0 is the list itself,
+ * nodes that are taller than one level carry a tower with one link per upper
+ * level. Every link stores how many positions it spans, so the nth node is
+ * found by walking down the levels, summing widths, in O(log n) expected.
+ */
+static skip_link_t *skip_link(const sll_t *p_list, node_t *p_node, int level)
 {
-    node_t *p_new_node = allocate_node(val);
-    p_list->p_head = p_new_node;
-    p_list->p_tail = p_new_node;
+    // NULL stands for the head
+    return p_node ? &p_node->p_tower->links[level - 1] : (skip_link_t *)&p_list->skip_head[level];
 }
 
-void list_append_to_head(sll_t *p_list, int val)
+static int skip_random_height(sll_t *p_list)
+{
+    // xorshift32, two bits per level gives p = 1/4
+    uint32_t x = p_list->skip_rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    p_list->skip_rng = x;
+
+    int height = 1;
+    while(height < SKIP_MAX_LEVEL && (x & 3) == 0)
+    {
+        height++;
+        x >>= 2;
+    }
+
+    return height;
+}
+
+// A node that can't get its tower just stays on level 0
+static int skip_attach_tower(sll_t *p_list, node_t *p_node)
+{
+    int height = skip_random_height(p_list);
+
+    p_node->p_tower = NULL;
+
+    if(height > 1)
+    {
+        p_node->p_tower = malloc(sizeof(skip_tower_t) + sizeof(skip_link_t) * (height - 1));
+
+        if(!p_node->p_tower)
+        {
+            return 1;
+        }
+
+        p_node->p_tower->height = height;
+    }
+
+    return height;
+}
+
+// Fills pp_update/p_rank with the last node before 1-based position target
+// on every upper level, NULL meaning the head (rank 0)
+static void skip_find_prev(const sll_t *p_list, size_t target, node_t **pp_update, size_t *p_rank)
+{
+    node_t *p_node = NULL;
+    size_t rank = 0;
+
+    for(int level = p_list->skip_levels - 1; level >= 1; level--)
+    {
+        skip_link_t *p_link = skip_link(p_list, p_node, level);
+
+        while(p_link->p_next && rank + p_link->width < target)
+        {
+            rank += p_link->width;
+            p_node = p_link->p_next;
+            p_link = skip_link(p_list, p_node, level);
+        }
+
+        pp_update[level] = p_node;
+        p_rank[level] = rank;
+    }
+}
+
+static void skip_insert(sll_t *p_list, node_t *p_node, size_t target)
+{
+    node_t *update[SKIP_MAX_LEVEL];
+    size_t rank[SKIP_MAX_LEVEL];
+
+    skip_find_prev(p_list, target, update, rank);
+
+    int height = skip_attach_tower(p_list, p_node);
+
+    for(int level = p_list->skip_levels; level < height; level++)
+    {
+        update[level] = NULL;
+        rank[level] = 0;
+        p_list->skip_head[level].p_next = NULL;
+        p_list->skip_head[level].width = 0;
+    }
+
+    if(height > p_list->skip_levels)
+    {
+        p_list->skip_levels = height;
+    }
+
+    for(int level = 1; level < p_list->skip_levels; level++)
+    {
+        skip_link_t *p_prev_link = skip_link(p_list, update[level], level);
+
+        if(level < height)
+        {
+            skip_link_t *p_new_link = &p_node->p_tower->links[level - 1];
+
+            p_new_link->p_next = p_prev_link->p_next;
+            p_new_link->width = rank[level] + p_prev_link->width + 1 - target;
+            p_prev_link->p_next = p_node;
+            p_prev_link->width = target - rank[level];
+        }
+        else
+        {
+            // The new node lies under this link
+            p_prev_link->width++;
+        }
+    }
+}
+
+static void skip_remove(sll_t *p_list, node_t *p_node, size_t target)
+{
+    node_t *update[SKIP_MAX_LEVEL];
+    size_t rank[SKIP_MAX_LEVEL];
+
+    skip_find_prev(p_list, target, update, rank);
+
+    for(int level = 1; level < p_list->skip_levels; level++)
+    {
+        skip_link_t *p_prev_link = skip_link(p_list, update[level], level);
+
+        if(p_prev_link->p_next == p_node)
+        {
+            skip_link_t *p_node_link = &p_node->p_tower->links[level - 1];
+
+            p_prev_link->width += p_node_link->width - 1;
+            p_prev_link->p_next = p_node_link->p_next;
+        }
+        else
+        {
+            p_prev_link->width--;
+        }
+    }
+
+    while(p_list->skip_levels > 1 && !p_list->skip_head[p_list->skip_levels - 1].p_next)
+    {
+        p_list->skip_levels--;
+    }
+
+    free(p_node->p_tower);
+    p_node->p_tower = NULL;
+}
+
+// Builds the skip index over the current nodes in one pass
+void list_enable_skip_index(sll_t *p_list)
 {
     assert(p_list);
 
-    node_t *p_new_node = allocate_node(val);
+    if(p_list->has_skip_index)
+    {
+        return;
+    }
+
+    node_t *last[SKIP_MAX_LEVEL];
+    size_t last_rank[SKIP_MAX_LEVEL];
+    size_t rank = 0;
+
+    p_list->has_skip_index = true;
+    p_list->skip_levels = 1;
+
+    for(node_t *p_node = p_list->p_head; p_node; p_node = p_node->p_next)
+    {
+        int height = skip_attach_tower(p_list, p_node);
+        rank++;
+
+        for(int level = p_list->skip_levels; level < height; level++)
+        {
+            last[level] = NULL;
+            last_rank[level] = 0;
+        }
+
+        if(height > p_list->skip_levels)
+        {
+            p_list->skip_levels = height;
+        }
+
+        for(int level = 1; level < height; level++)
+        {
+            skip_link_t *p_link = skip_link(p_list, last[level], level);
+
+            p_link->p_next = p_node;
+            p_link->width = rank - last_rank[level];
+            last[level] = p_node;
+            last_rank[level] = rank;
+        }
+    }
+
+    // Terminate every level
+    for(int level = 1; level < p_list->skip_levels; level++)
+    {
+        skip_link_t *p_link = skip_link(p_list, last[level], level);
+
+        p_link->p_next = NULL;
+        p_link->width = rank + 1 - last_rank[level];
+    }
+}
+
+void list_disable_skip_index(sll_t *p_list)
+{
+    assert(p_list);
+
+    for(node_t *p_node = p_list->p_head; p_node; p_node = p_node->p_next)
+    {
+        free(p_node->p_tower);
+        p_node->p_tower = NULL;
+    }
+
+    p_list->has_skip_index = false;
+    p_list->skip_levels = 1;
+}
+
+// Returns the node at 0-based position n, NULL if out of range
+static node_t *list_nth_node(const sll_t *p_list, size_t n)
+{
+    if(n >= p_list->size)
+    {
+        return NULL;
+    }
+
+    node_t *p_node;
+
+    if(!p_list->has_skip_index)
+    {
+        // Walk from whichever end is closer
+        if(n < p_list->size / 2)
+        {
+            for(p_node = p_list->p_head; n; n--)
+            {
+                p_node = p_node->p_next;
+            }
+        }
+        else
+        {
+            p_node = p_list->p_tail;
+            for(size_t i = p_list->size - 1; i > n; i--)
+            {
+                p_node = p_node->p_prev;
+            }
+        }
+
+        return p_node;
+    }
+
+    size_t target = n + 1;
+    size_t rank = 0;
+    p_node = NULL;
+
+    for(int level = p_list->skip_levels - 1; level >= 1; level--)
+    {
+        skip_link_t *p_link = skip_link(p_list, p_node, level);
+
+        while(p_link->p_next && rank + p_link->width <= target)
+        {
+            rank += p_link->width;
+            p_node = p_link->p_next;
+            p_link = skip_link(p_list, p_node, level);
+        }
+    }
+
+    if(!p_node)
+    {
+        p_node = p_list->p_head;
+        rank = 1;
+    }
+
+    for(; rank < target; rank++)
+    {
+        p_node = p_node->p_next;
+    }
 
-    if(p_list->p_head)
+    return p_node;
+}
+
+// Links p_node in after p_prev (NULL = at the head), it becomes position pos
+static void link_node(sll_t *p_list, node_t *p_prev, node_t *p_node, size_t pos)
+{
+    node_t *p_next = p_prev ? p_prev->p_next : p_list->p_head;
+
+    p_node->p_prev = p_prev;
+    p_node->p_next = p_next;
+
+    if(p_prev)
+    {
+        p_prev->p_next = p_node;
+    }
+    else
+    {
+        p_list->p_head = p_node;
+    }
+
+    if(p_next)
     {
-        p_new_node->p_next = p_list->p_head;
+        p_next->p_prev = p_node;
     }
     else
     {
-        p_list->p_tail = p_new_node;
+        p_list->p_tail = p_node;
+    }
+
+    if(p_list->has_skip_index)
+    {
+        skip_insert(p_list, p_node, pos + 1);
     }
 
-    p_list->p_head = p_new_node;
     p_list->size++;
-    
 }
 
-void list_append_to_tail(sll_t *p_list, int val)
+// Unlinks p_node, which is at position pos
+static void unlink_node(sll_t *p_list, node_t *p_node, size_t pos)
+{
+    if(p_list->has_skip_index)
+    {
+        skip_remove(p_list, p_node, pos + 1);
+    }
+
+    if(p_node->p_prev)
+    {
+        p_node->p_prev->p_next = p_node->p_next;
+    }
+    else
+    {
+        p_list->p_head = p_node->p_next;
+    }
+
+    if(p_node->p_next)
+    {
+        p_node->p_next->p_prev = p_node->p_prev;
+    }
+    else
+    {
+        p_list->p_tail = p_node->p_prev;
+    }
+
+    p_list->size--;
+}
+
+void list_init(sll_t *p_list, int val)
 {
     assert(p_list);
 
+    p_list->p_head = NULL;
+    p_list->p_tail = NULL;
+    p_list->size = 0;
+    p_list->has_skip_index = false;
+    p_list->skip_levels = 1;
+    p_list->skip_rng = 0x9E3779B9;
+
     node_t *p_new_node = allocate_node(val);
 
-    if(p_list->p_tail)
+    if(p_new_node)
     {
-        p_list->p_tail->p_next = p_new_node;
+        link_node(p_list, NULL, p_new_node, 0);
     }
-    else
+}
+
+void list_deinit(sll_t *p_list)
+{
+    assert(p_list);
+
+    node_t *p_cur = p_list->p_head;
+
+    while(p_cur)
     {
-        p_list->p_head = p_new_node;
+        node_t *p_next = p_cur->p_next;
+        free_node(p_cur);
+        p_cur = p_next;
     }
 
-    p_list->p_tail = p_new_node;
-    p_list->size++;
+    p_list->p_head = NULL;
+    p_list->p_tail = NULL;
+    p_list->size = 0;
+    p_list->has_skip_index = false;
+    p_list->skip_levels = 1;
 }
 
-bool list_append_to_nth(sll_t *p_list, int val, int n)
+bool list_append_to_head(sll_t *p_list, int val)
 {
     assert(p_list);
 
-    if(!p_list->p_head || p_list->size < n || n == 0)
+    node_t *p_new_node = allocate_node(val);
+
+    if(!p_new_node)
     {
         return false;
     }
 
-    node_t *prev = NULL;
-    node_t *curr = p_list->p_head;
-    while(n)
+    link_node(p_list, NULL, p_new_node, 0);
+
+    return true;
+}
+
+bool list_append_to_tail(sll_t *p_list, int val)
+{
+    assert(p_list);
+
+    node_t *p_new_node = allocate_node(val);
+
+    if(!p_new_node)
     {
-        prev = curr;
-        curr = curr->p_next;
-        n--;
+        return false;
     }
 
-    node_t *new_node = allocate_node(val);
-    prev->p_next = new_node;
-    new_node->p_next = curr;
-    p_list->size++;
+    link_node(p_list, p_list->p_tail, p_new_node, p_list->size);
 
     return true;
 }
 
-bool list_delete_nth(sll_t *p_list, int n, int *out_val)
+// Inserts val so that it becomes the nth node (1 <= n <= size)
+bool list_append_to_nth(sll_t *p_list, int val, int n)
 {
     assert(p_list);
 
-    if (!p_list->p_head || n < 0)
+    if(n <= 0 || (size_t)n > p_list->size)
+    {
         return false;
+    }
 
-    node_t *prev = NULL;
-    node_t *curr = p_list->p_head;
+    node_t *p_new_node = allocate_node(val);
 
-    // Special case: deleting the head node
-    if (n == 0) 
+    if(!p_new_node)
     {
-        if (out_val) *out_val = curr->val;
+        return false;
+    }
 
-        p_list->p_head = curr->p_next;
+    link_node(p_list, list_nth_node(p_list, n - 1), p_new_node, n);
 
-        // If it was the only node, update tail
-        if (p_list->p_tail == curr)
-            p_list->p_tail = NULL;
+    return true;
+}
 
-        free_node(curr);
-        return true;
-    }
+bool list_delete_nth(sll_t *p_list, int n, int *out_val)
+{
+    assert(p_list);
 
-    // Traverse to the nth node
-    for (int i = 0; i < n && curr != NULL; i++) 
+    if(n < 0 || (size_t)n >= p_list->size)
     {
-        prev = curr;
-        curr = curr->p_next;
+        return false; // Index out of bounds
     }
 
-    if (!curr) return false; // Index out of bounds
+    node_t *p_node = list_nth_node(p_list, n);
 
-    if (out_val) *out_val = curr->val;
+    if(out_val) *out_val = p_node->val;
 
-    prev->p_next = curr->p_next;
+    unlink_node(p_list, p_node, n);
+    free_node(p_node);
 
-    // If deleting the tail
-    if (curr == p_list->p_tail)
-        p_list->p_tail = prev;
+    return true;
+}
 
-    free_node(curr);
-    p_list->size--;
+bool list_get_nth(const sll_t *p_list, int n, int *out_val)
+{
+    assert(p_list);
+
+    if(n < 0)
+    {
+        return false;
+    }
+
+    node_t *p_node = list_nth_node(p_list, n);
+
+    if(!p_node)
+    {
+        return false;
+    }
+
+    *out_val = p_node->val;
 
     return true;
 }
 
-
 int list_pop_from_head(sll_t *p_list)
 {
     assert(p_list);
 
-    res = INT_MIN;
+    int res = INT_MIN;
+    node_t *p_node = p_list->p_head;
 
-    if(p_list->p_head)
+    if(p_node)
     {
-        res = p_list->p_head->val;
+        res = p_node->val;
+        unlink_node(p_list, p_node, 0);
+        free_node(p_node);
+    }
+
+    return res;
+}
 
-        node_t *p_temp = p_list->p_head->p_next;
-        free_node(p_list->p_head);
-        p_list->p_head = p_temp;
+int list_pop_from_tail(sll_t *p_list)
+{
+    assert(p_list);
 
-        if(!p_temp)
-        {
-            p_list->tail = NULL;
-        }
+    int res = INT_MIN;
+    node_t *p_node = p_list->p_tail;
 
-        p_list->size--;
+    if(p_node)
+    {
+        res = p_node->val;
+        unlink_node(p_list, p_node, p_list->size - 1);
+        free_node(p_node);
     }
 
     return res;
 }
 
-int list_pop_from_tail(sll_t *p_list)
+/*
+ * Cursor
+ *
+ * A cursor remembers a node and its position. Seeking walks from whichever
+ * of head, tail or the current position is closest (or uses the skip index
+ * for long jumps), so a run of edits close to each other costs O(distance)
+ * per edit instead of O(n). Edits made without the cursor invalidate it.
+ */
+void list_cursor_init(sll_cursor_t *p_cursor, sll_t *p_list)
 {
+    assert(p_cursor);
     assert(p_list);
 
-    res = INT_MIN;
+    p_cursor->p_list = p_list;
+    p_cursor->p_node = p_list->p_head;
+    p_cursor->pos = 0;
+}
 
-    if(p_list->p_tail)
+bool list_cursor_seek(sll_cursor_t *p_cursor, size_t pos)
+{
+    assert(p_cursor);
+
+    sll_t *p_list = p_cursor->p_list;
+
+    if(pos > p_list->size)
+    {
+        return false;
+    }
+
+    if(pos == p_list->size)
+    {
+        p_cursor->p_node = NULL;
+        p_cursor->pos = pos;
+        return true;
+    }
+
+    node_t *p_node = p_list->p_head;
+    size_t start = 0;
+    size_t distance = pos;
+
+    if(p_list->size - 1 - pos < distance)
     {
-        res = p_list->p_tail->val;
-    
-        node_t *p_prev = NULL;
-        node_t *p_cur = p_list->p_head;
+        p_node = p_list->p_tail;
+        start = p_list->size - 1;
+        distance = p_list->size - 1 - pos;
+    }
 
-        while(p_cur->p_next != NULL)
+    if(p_cursor->p_node)
+    {
+        size_t from_cursor = (pos > p_cursor->pos) ? pos - p_cursor->pos : p_cursor->pos - pos;
+
+        if(from_cursor < distance)
         {
-            p_prev = p_cur;
-            p_cur = p_cur->p_next;
+            p_node = p_cursor->p_node;
+            start = p_cursor->pos;
+            distance = from_cursor;
         }
+    }
 
-        free_node(p_list->p_tail);
-        p_list->p_tail = p_prev;
-
-        if(!p_prev)
+    if(p_list->has_skip_index && distance > SKIP_SEEK_THRESHOLD)
+    {
+        p_node = list_nth_node(p_list, pos);
+    }
+    else
+    {
+        for(; start < pos; start++)
         {
-            p_list->p_head = NULL;
+            p_node = p_node->p_next;
         }
-        else
+
+        for(; start > pos; start--)
         {
-            p_prev->p_next = NULL;
+            p_node = p_node->p_prev;
         }
+    }
+
+    p_cursor->p_node = p_node;
+    p_cursor->pos = pos;
+
+    return true;
+}
 
-        p_list->size--;
+bool list_cursor_next(sll_cursor_t *p_cursor)
+{
+    assert(p_cursor);
+
+    if(!p_cursor->p_node)
+    {
+        return false;
     }
 
-    return res;
+    p_cursor->p_node = p_cursor->p_node->p_next;
+    p_cursor->pos++;
+
+    return true;
+}
+
+bool list_cursor_get(const sll_cursor_t *p_cursor, int *out_val)
+{
+    assert(p_cursor);
+
+    if(!p_cursor->p_node)
+    {
+        return false;
+    }
+
+    *out_val = p_cursor->p_node->val;
+
+    return true;
+}
+
+// Inserts val at the cursor position, the cursor then points at the new node
+bool list_cursor_insert(sll_cursor_t *p_cursor, int val)
+{
+    assert(p_cursor);
+
+    node_t *p_new_node = allocate_node(val);
+
+    if(!p_new_node)
+    {
+        return false;
+    }
+
+    sll_t *p_list = p_cursor->p_list;
+    node_t *p_prev = p_cursor->p_node ? p_cursor->p_node->p_prev : p_list->p_tail;
+
+    link_node(p_list, p_prev, p_new_node, p_cursor->pos);
+    p_cursor->p_node = p_new_node;
+
+    return true;
+}
+
+// Deletes the node at the cursor, the cursor then points at the next node
+bool list_cursor_delete(sll_cursor_t *p_cursor, int *out_val)
+{
+    assert(p_cursor);
+
+    node_t *p_node = p_cursor->p_node;
+
+    if(!p_node)
+    {
+        return false;
+    }
+
+    if(out_val) *out_val = p_node->val;
+
+    p_cursor->p_node = p_node->p_next;
+    unlink_node(p_cursor->p_list, p_node, p_cursor->pos);
+    free_node(p_node);
+
+    return true;
 }
 
 void print_list(const sll_t *p_list)
@@ -267,5 +798,32 @@ int main(void)
     printf("%d\n", val);
     print_list(&list);
 
+    printf("\nCursor edits: insert 1..5, double every other value\n");
+    sll_cursor_t cursor;
+    list_cursor_init(&cursor, &list);
+    for(int i = 1; i <= 5; i++)
+    {
+        list_cursor_seek(&cursor, list.size);
+        list_cursor_insert(&cursor, i);
+    }
+    for(size_t pos = 0; pos < list.size; pos += 2)
+    {
+        list_cursor_seek(&cursor, pos);
+        list_cursor_delete(&cursor, &val);
+        list_cursor_insert(&cursor, val * 2);
+    }
+    print_list(&list);
+
+    printf("\nSkip index on 100000 nodes, value at position 54321: ");
+    for(int i = 0; i < 100000; i++)
+    {
+        list_append_to_tail(&list, i);
+    }
+    list_enable_skip_index(&list);
+    list_get_nth(&list, 54321 + 5, &val);
+    printf("%d\n", val);
+
+    list_deinit(&list);
+
     return 0;
 }
@@ -1,4 +1,6 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <stdbool.h>
 #include <stdint.h>
 
@@ -74,6 +76,162 @@ void stack_print(const Stack *s)
     printf("\n");
 }
 
+/*
+ * Growable array stack
+ *
+ * Same contiguous layout as Stack, but the array doubles when it is full so
+ * the depth is only limited by memory. With shrinking enabled it halves
+ * once it drops to a quarter full; the gap between the grow and shrink
+ * points keeps a push/pop loop at a boundary from reallocating every time.
+ * Errors are reported by return value only, nothing is printed.
+ */
+#define DSTACK_MIN_CAPACITY 16
+
+typedef struct {
+    int *data;
+    size_t size;
+    size_t capacity;
+    bool shrink;    // Give memory back when the stack empties out
+} DynStack;
+
+/* Initialize the stack, nothing is allocated until the first push */
+void dstack_init(DynStack *s, bool shrink)
+{
+    s->data = NULL;
+    s->size = 0;
+    s->capacity = 0;
+    s->shrink = shrink;
+}
+
+/* Free the array */
+void dstack_free(DynStack *s)
+{
+    free(s->data);
+    s->data = NULL;
+    s->size = 0;
+    s->capacity = 0;
+}
+
+static bool dstack_resize(DynStack *s, size_t capacity)
+{
+    int *data = realloc(s->data, capacity * sizeof(int));
+
+    if (!data)
+    {
+        return false;
+    }
+
+    s->data = data;
+    s->capacity = capacity;
+    return true;
+}
+
+/* Make room for at least capacity values */
+bool dstack_reserve(DynStack *s, size_t capacity)
+{
+    if (capacity <= s->capacity)
+    {
+        return true;
+    }
+
+    size_t new_capacity = s->capacity ? s->capacity : DSTACK_MIN_CAPACITY;
+
+    while (new_capacity < capacity)
+    {
+        if (new_capacity > SIZE_MAX / 2 / sizeof(int))
+        {
+            return false;
+        }
+
+        new_capacity *= 2;
+    }
+
+    return dstack_resize(s, new_capacity);
+}
+
+static void dstack_maybe_shrink(DynStack *s)
+{
+    // pop_n can empty out several halvings at once
+    while (s->shrink && s->capacity > DSTACK_MIN_CAPACITY && s->size <= s->capacity / 4)
+    {
+        // A failed shrink just keeps the bigger array
+        if (!dstack_resize(s, s->capacity / 2))
+        {
+            break;
+        }
+    }
+}
+
+/* Check if stack is empty */
+bool dstack_is_empty(const DynStack *s)
+{
+    return s->size == 0;
+}
+
+/* Push value onto stack, fails only if the array can't grow */
+bool dstack_push(DynStack *s, int value)
+{
+    if (s->size == s->capacity && !dstack_reserve(s, s->size + 1))
+    {
+        return false;
+    }
+
+    s->data[s->size++] = value;
+    return true;
+}
+
+/* Pop value from stack */
+bool dstack_pop(DynStack *s, int *out_value)
+{
+    if (dstack_is_empty(s))
+    {
+        return false;
+    }
+
+    *out_value = s->data[--s->size];
+    dstack_maybe_shrink(s);
+    return true;
+}
+
+/* Peek at the top value without popping */
+bool dstack_peek(const DynStack *s, int *out_value)
+{
+    if (dstack_is_empty(s))
+    {
+        return false;
+    }
+
+    *out_value = s->data[s->size - 1];
+    return true;
+}
+
+/* Push values[0] .. values[n - 1], values[n - 1] ends up on top */
+bool dstack_push_n(DynStack *s, const int *values, size_t n)
+{
+    if (n > SIZE_MAX - s->size || !dstack_reserve(s, s->size + n))
+    {
+        return false;
+    }
+
+    memcpy(&s->data[s->size], values, n * sizeof(int));
+    s->size += n;
+    return true;
+}
+
+/*
+ * Pop up to n values into out, in the order dstack_push_n takes them
+ * (out[count - 1] is the old top). Returns how many were popped.
+ */
+size_t dstack_pop_n(DynStack *s, int *out, size_t n)
+{
+    size_t count = (n < s->size) ? n : s->size;
+
+    s->size -= count;
+    memcpy(out, &s->data[s->size], count * sizeof(int));
+    dstack_maybe_shrink(s);
+    return count;
+}
+
 /* Example usage */
 int main(void)
 {
@@ -95,5 +253,20 @@ int main(void)
 
     stack_print(&s);
 
+    DynStack ds;
+    dstack_init(&ds, true);
+
+    for (int i = 0; i < 1000; i++)
+        dstack_push(&ds, i);
+
+    int batch[4] = {1, 2, 3, 4};
+    dstack_push_n(&ds, batch, 4);
+    size_t popped = dstack_pop_n(&ds, batch, 4);
+    printf("Popped %zu, new top batch: %d %d %d %d\n", popped, batch[0], batch[1], batch[2], batch[3]);
+
+    dstack_peek(&ds, &val);
+    printf("DynStack size=%zu capacity=%zu top=%d\n", ds.size, ds.capacity, val);
+
+    dstack_free(&ds);
     return 0;
 }
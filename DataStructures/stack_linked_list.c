@@ -1,6 +1,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
 
 /* Define a node structure */
 typedef struct Node {
@@ -93,6 +95,402 @@ void stack_print(const Stack *stack)
     printf("\n");
 }
 
+/*
+ * Lock-free (Treiber) stack
+ *
+ * top is a single 64-bit word: a 32-bit node index plus a 32-bit tag that
+ * is bumped on every successful CAS, so a node that is popped and pushed
+ * back between another thread's read and CAS (ABA) makes that CAS fail.
+ * Using indices instead of pointers keeps the tagged word at 64 bits, so a
+ * plain 64-bit CAS is enough on every target.
+ *
+ * Nodes live in chunks owned by the stack and are never freed while it is
+ * in use. Popped nodes go onto a second tagged stack and are reused, which
+ * makes reading a node another thread just popped harmless.
+ *
+ * The element count is kept in striped per-thread counters so push/pop do
+ * not share one more hot cache line; lf_stack_size() is approximate while
+ * other threads are running.
+ */
+#define LF_CHUNK_BITS   12
+#define LF_CHUNK_SIZE   (1u << LF_CHUNK_BITS)   /* Nodes per chunk */
+#define LF_MAX_CHUNKS   (1u << 16)              /* Up to 2^28 nodes */
+#define LF_SIZE_STRIPES 16
+#define LF_NULL_INDEX   0                       /* Index 0 is never handed out */
+#define CACHE_LINE_SIZE 64
+
+typedef struct {
+    int data;
+    _Atomic uint32_t next;  /* Index of the next node */
+} LfNode;
+
+typedef struct {
+    _Alignas(CACHE_LINE_SIZE) atomic_long count;
+} LfSizeStripe;
+
+typedef struct {
+    _Alignas(CACHE_LINE_SIZE) _Atomic uint64_t top;      /* tag << 32 | index */
+    _Alignas(CACHE_LINE_SIZE) _Atomic uint64_t free_top; /* Recycled nodes */
+    _Alignas(CACHE_LINE_SIZE) _Atomic uint32_t next_index;
+    _Atomic(LfNode *) *chunks;
+    LfSizeStripe size[LF_SIZE_STRIPES];
+} LfStack;
+
+static inline uint32_t lf_index(uint64_t word)
+{
+    return (uint32_t)word;
+}
+
+static inline uint64_t lf_word(uint32_t index, uint64_t old_word)
+{
+    return ((uint64_t)((uint32_t)(old_word >> 32) + 1) << 32) | index;
+}
+
+static inline LfNode *lf_node(LfStack *stack, uint32_t index)
+{
+    LfNode *chunk = atomic_load_explicit(&stack->chunks[index >> LF_CHUNK_BITS], memory_order_acquire);
+    return &chunk[index & (LF_CHUNK_SIZE - 1)];
+}
+
+/* Each thread sticks to one size stripe */
+static LfSizeStripe *lf_size_stripe(LfStack *stack)
+{
+    static atomic_uint next_stripe;
+    static _Thread_local unsigned stripe = LF_SIZE_STRIPES;
+
+    if (stripe == LF_SIZE_STRIPES)
+        stripe = atomic_fetch_add_explicit(&next_stripe, 1, memory_order_relaxed) % LF_SIZE_STRIPES;
+
+    return &stack->size[stripe];
+}
+
+static void lf_list_push(LfStack *stack, _Atomic uint64_t *head, uint32_t index)
+{
+    LfNode *node = lf_node(stack, index);
+    uint64_t old_word = atomic_load_explicit(head, memory_order_relaxed);
+
+    do {
+        atomic_store_explicit(&node->next, lf_index(old_word), memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak_explicit(head, &old_word, lf_word(index, old_word),
+                                                    memory_order_release, memory_order_relaxed));
+}
+
+static uint32_t lf_list_pop(LfStack *stack, _Atomic uint64_t *head)
+{
+    uint64_t old_word = atomic_load_explicit(head, memory_order_acquire);
+    uint32_t next;
+
+    do {
+        if (lf_index(old_word) == LF_NULL_INDEX)
+            return LF_NULL_INDEX;
+
+        /* The node may be popped and reused meanwhile, the tag catches that */
+        next = atomic_load_explicit(&lf_node(stack, lf_index(old_word))->next, memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak_explicit(head, &old_word, lf_word(next, old_word),
+                                                    memory_order_acquire, memory_order_acquire));
+
+    return lf_index(old_word);
+}
+
+/* Get a node from the recycle list, or carve a new one out of a chunk */
+static uint32_t lf_node_alloc(LfStack *stack)
+{
+    uint32_t index = lf_list_pop(stack, &stack->free_top);
+
+    if (index != LF_NULL_INDEX)
+        return index;
+
+    index = atomic_fetch_add_explicit(&stack->next_index, 1, memory_order_relaxed);
+
+    if ((index >> LF_CHUNK_BITS) >= LF_MAX_CHUNKS)
+        return LF_NULL_INDEX;  /* out of indices */
+
+    _Atomic(LfNode *) *slot = &stack->chunks[index >> LF_CHUNK_BITS];
+
+    if (!atomic_load_explicit(slot, memory_order_acquire)) {
+        /* Several threads may race to allocate the same chunk, one wins */
+        LfNode *chunk = calloc(LF_CHUNK_SIZE, sizeof(LfNode));
+        LfNode *expected = NULL;
+
+        if (!chunk)
+            return LF_NULL_INDEX;
+
+        if (!atomic_compare_exchange_strong_explicit(slot, &expected, chunk,
+                                                     memory_order_acq_rel, memory_order_acquire))
+            free(chunk);
+    }
+
+    return index;
+}
+
+/* Initialize lock-free stack */
+bool lf_stack_init(LfStack *stack)
+{
+    stack->chunks = calloc(LF_MAX_CHUNKS, sizeof(*stack->chunks));
+    if (!stack->chunks)
+        return false;
+
+    atomic_init(&stack->top, LF_NULL_INDEX);
+    atomic_init(&stack->free_top, LF_NULL_INDEX);
+    atomic_init(&stack->next_index, 1);
+
+    for (int i = 0; i < LF_SIZE_STRIPES; i++)
+        atomic_init(&stack->size[i].count, 0);
+
+    return true;
+}
+
+/* Push value onto lock-free stack */
+bool lf_stack_push(LfStack *stack, int value)
+{
+    uint32_t index = lf_node_alloc(stack);
+    if (index == LF_NULL_INDEX)
+        return false;  // allocation failed
+
+    lf_node(stack, index)->data = value;
+    lf_list_push(stack, &stack->top, index);
+    atomic_fetch_add_explicit(&lf_size_stripe(stack)->count, 1, memory_order_relaxed);
+    return true;
+}
+
+/* Pop value from lock-free stack */
+bool lf_stack_pop(LfStack *stack, int *out_value)
+{
+    uint32_t index = lf_list_pop(stack, &stack->top);
+    if (index == LF_NULL_INDEX)
+        return false;
+
+    *out_value = lf_node(stack, index)->data;
+    lf_list_push(stack, &stack->free_top, index);
+    atomic_fetch_sub_explicit(&lf_size_stripe(stack)->count, 1, memory_order_relaxed);
+    return true;
+}
+
+/* Check if lock-free stack is empty */
+bool lf_stack_is_empty(LfStack *stack)
+{
+    return lf_index(atomic_load_explicit(&stack->top, memory_order_acquire)) == LF_NULL_INDEX;
+}
+
+/* Approximate element count, exact when no other thread is pushing or popping */
+size_t lf_stack_size(LfStack *stack)
+{
+    long total = 0;
+
+    for (int i = 0; i < LF_SIZE_STRIPES; i++)
+        total += atomic_load_explicit(&stack->size[i].count, memory_order_relaxed);
+
+    return total > 0 ? (size_t)total : 0;
+}
+
+/* Free all chunks, no other thread may use the stack anymore */
+void lf_stack_free(LfStack *stack)
+{
+    for (uint32_t i = 0; i < LF_MAX_CHUNKS; i++)
+        free(atomic_load_explicit(&stack->chunks[i], memory_order_relaxed));
+
+    free(stack->chunks);
+    stack->chunks = NULL;
+    atomic_store_explicit(&stack->top, LF_NULL_INDEX, memory_order_relaxed);
+    atomic_store_explicit(&stack->free_top, LF_NULL_INDEX, memory_order_relaxed);
+}
+
+/*
+ * Magazine layer
+ *
+ * Each thread keeps a MagCache holding two magazines (small value arrays):
+ * "loaded" serves push/pop, "previous" is either empty or non-empty and is
+ * swapped in when loaded runs full/empty. Only when both are exhausted does
+ * the thread touch shared state, and then it trades a whole magazine with
+ * the depot: two LfStacks holding indices of non-empty and empty magazines.
+ * Most push/pop calls therefore stay in thread-local memory.
+ *
+ * A value pushed by one thread is only visible to others once its magazine
+ * reaches the depot, so mag_pop can report empty while other caches still
+ * hold values. Call mag_cache_flush before a thread exits.
+ */
+#define MAG_SIZE          32
+#define MAG_MAX_MAGAZINES (1u << 16)
+
+typedef struct {
+    int count;
+    int values[MAG_SIZE];
+} Magazine;
+
+typedef struct {
+    LfStack full;       /* Indices of non-empty magazines */
+    LfStack empty;      /* Indices of empty magazines */
+    _Atomic(Magazine *) *magazines;
+    _Atomic uint32_t next_magazine;
+} MagStack;
+
+typedef struct {
+    MagStack *stack;
+    int loaded;         /* Magazine indices, -1 when none is held */
+    int previous;
+} MagCache;
+
+static inline Magazine *mag_get(MagStack *stack, int index)
+{
+    return atomic_load_explicit(&stack->magazines[index], memory_order_acquire);
+}
+
+/* Take an empty magazine from the depot or allocate a new one, -1 on failure */
+static int mag_get_empty(MagStack *stack)
+{
+    int index;
+
+    if (lf_stack_pop(&stack->empty, &index))
+        return index;
+
+    uint32_t new_index = atomic_fetch_add_explicit(&stack->next_magazine, 1, memory_order_relaxed);
+    if (new_index >= MAG_MAX_MAGAZINES)
+        return -1;
+
+    Magazine *magazine = malloc(sizeof(Magazine));
+    if (!magazine)
+        return -1;
+
+    magazine->count = 0;
+    atomic_store_explicit(&stack->magazines[new_index], magazine, memory_order_release);
+    return (int)new_index;
+}
+
+/* Hand a magazine back to the depot list that matches its fill state */
+static bool mag_put(MagStack *stack, int index)
+{
+    return lf_stack_push(mag_get(stack, index)->count ? &stack->full : &stack->empty, index);
+}
+
+/* Initialize the shared depot */
+bool mag_stack_init(MagStack *stack)
+{
+    stack->magazines = calloc(MAG_MAX_MAGAZINES, sizeof(*stack->magazines));
+    if (!stack->magazines)
+        return false;
+
+    if (!lf_stack_init(&stack->full)) {
+        free(stack->magazines);
+        return false;
+    }
+
+    if (!lf_stack_init(&stack->empty)) {
+        lf_stack_free(&stack->full);
+        free(stack->magazines);
+        return false;
+    }
+
+    atomic_init(&stack->next_magazine, 0);
+    return true;
+}
+
+/* Free the depot and every magazine, all caches must be flushed or abandoned */
+void mag_stack_free(MagStack *stack)
+{
+    for (uint32_t i = 0; i < MAG_MAX_MAGAZINES; i++)
+        free(atomic_load_explicit(&stack->magazines[i], memory_order_relaxed));
+
+    free(stack->magazines);
+    stack->magazines = NULL;
+    lf_stack_free(&stack->full);
+    lf_stack_free(&stack->empty);
+}
+
+/* Initialize a per-thread cache, magazines are taken on first use */
+void mag_cache_init(MagCache *cache, MagStack *stack)
+{
+    cache->stack = stack;
+    cache->loaded = -1;
+    cache->previous = -1;
+}
+
+/* Push value, touches the depot only when both magazines are full */
+bool mag_push(MagCache *cache, int value)
+{
+    MagStack *stack = cache->stack;
+
+    if (cache->loaded < 0 && (cache->loaded = mag_get_empty(stack)) < 0)
+        return false;
+
+    Magazine *loaded = mag_get(stack, cache->loaded);
+
+    if (loaded->count == MAG_SIZE) {
+        Magazine *previous = cache->previous >= 0 ? mag_get(stack, cache->previous) : NULL;
+
+        if (previous && previous->count == 0) {
+            /* Swap in the empty previous magazine */
+            int tmp = cache->loaded;
+            cache->loaded = cache->previous;
+            cache->previous = tmp;
+        } else {
+            /* Trade the non-empty previous for an empty one from the depot */
+            int empty = mag_get_empty(stack);
+            if (empty < 0)
+                return false;
+
+            if (previous && !mag_put(stack, cache->previous)) {
+                lf_stack_push(&stack->empty, empty);
+                return false;
+            }
+
+            cache->previous = cache->loaded;
+            cache->loaded = empty;
+        }
+
+        loaded = mag_get(stack, cache->loaded);
+    }
+
+    loaded->values[loaded->count++] = value;
+    return true;
+}
+
+/* Pop value, touches the depot only when both magazines are empty */
+bool mag_pop(MagCache *cache, int *out_value)
+{
+    MagStack *stack = cache->stack;
+    Magazine *loaded = cache->loaded >= 0 ? mag_get(stack, cache->loaded) : NULL;
+
+    if (!loaded || loaded->count == 0) {
+        Magazine *previous = cache->previous >= 0 ? mag_get(stack, cache->previous) : NULL;
+
+        if (previous && previous->count > 0) {
+            /* Swap in the non-empty previous magazine */
+            int tmp = cache->loaded;
+            cache->loaded = cache->previous;
+            cache->previous = tmp;
+        } else {
+            /* Trade the empty previous for a non-empty one from the depot */
+            int full;
+            if (!lf_stack_pop(&stack->full, &full))
+                return false;
+
+            if (previous)
+                mag_put(stack, cache->previous);
+
+            cache->previous = cache->loaded;
+            cache->loaded = full;
+        }
+
+        loaded = mag_get(stack, cache->loaded);
+    }
+
+    *out_value = loaded->values[--loaded->count];
+    return true;
+}
+
+/* Return both magazines to the depot, making their values visible to other threads */
+void mag_cache_flush(MagCache *cache)
+{
+    if (cache->loaded >= 0)
+        mag_put(cache->stack, cache->loaded);
+
+    if (cache->previous >= 0)
+        mag_put(cache->stack, cache->previous);
+
+    cache->loaded = -1;
+    cache->previous = -1;
+}
+
 /* Example usage */
 int main(void)
 {
@@ -114,5 +512,30 @@ int main(void)
     stack_print(&stack); // Stack: 20 10
 
     stack_free(&stack);
+
+    LfStack lf_stack;
+    if (!lf_stack_init(&lf_stack))
+        return 1;
+
+    lf_stack_push(&lf_stack, 10);
+    lf_stack_push(&lf_stack, 20);
+    lf_stack_pop(&lf_stack, &val);
+    printf("Lock-free popped: %d, size=%zu\n", val, lf_stack_size(&lf_stack));
+
+    lf_stack_free(&lf_stack);
+
+    MagStack pool;
+    MagCache cache;
+    if (!mag_stack_init(&pool))
+        return 1;
+
+    mag_cache_init(&cache, &pool);
+    for (int i = 0; i < 100; i++)
+        mag_push(&cache, i);
+    mag_pop(&cache, &val);
+    printf("Magazine popped: %d\n", val);
+
+    mag_cache_flush(&cache);
+    mag_stack_free(&pool);
     return 0;
 }
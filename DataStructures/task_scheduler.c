@@ -1,101 +1,1513 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdbool.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+#if defined(__linux__)
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#endif
+
+// Task tablosu, heap ve boş id'ler bu boyutta statik dizilerdir.
+// Hedefte RAM kısıtlı olduğundan varsayılan küçüktür, derlerken değiştirilebilir.
+#ifndef TASK_COUNT
+#if defined(__linux__)
+#define TASK_COUNT 4096
+#else
+#define TASK_COUNT 16
+#endif
+#endif
+#define INVALID_TASK_ID (-1)
+#define CACHE_LINE_SIZE 64
+
+// Task başına istatistik (~1.7KB/task). Hedefte RAM kısıtlıysa 0 ile kapatılabilir.
+#ifndef TASK_STATS_ENABLED
+#if defined(__linux__)
+#define TASK_STATS_ENABLED 1
+#else
+#define TASK_STATS_ENABLED 0
+#endif
+#endif
 
-#define TASK_COUNT 5
+// HDR tarzı log-lineer histogram: 16us'ye kadar birebir, sonra her 2'nin kuvveti
+// aralığı 8 eşit parçaya bölünür (en fazla %12.5 hata). 2^28 us üstü son kovaya düşer.
+#define HIST_SUB_BITS 3
+#define HIST_SUB_COUNT (1 << HIST_SUB_BITS)
+#define HIST_MAX_BITS 28
+#define HIST_BUCKETS ((HIST_MAX_BITS - HIST_SUB_BITS + 1) * HIST_SUB_COUNT)
 
 typedef void (*callback_t)(void);
 
+// Executor modunda task bir sonraki periyodunda hala çalışıyorsa ne olacağı
+typedef enum {
+    TASK_OVERLAP_SKIP,      // bu periyot atlanır
+    TASK_OVERLAP_QUEUE,     // mevcut koşu bitince aynı worker tekrar çalıştırır
+} overlap_policy_t;
+
+// Task birden fazla periyot geride kaldığında ne yapılacağı
+typedef enum {
+    TASK_CATCHUP_ALL,       // kaçırılan her periyot sırayla çalışır
+    TASK_CATCHUP_SKIP,      // deadline'ı geçmiş periyotlar atlanır, faz korunur
+    TASK_CATCHUP_RESTART,   // geride kalınca periyot bu koşudan yeniden başlar, faz kayar
+} catchup_policy_t;
+
+// Aynı tick'te vadesi gelen task'ların hangi sırayla çalışacağı
+typedef enum {
+    TASK_DISPATCH_FIFO,     // planlanan zamana göre (eski davranış)
+    TASK_DISPATCH_RM,       // rate-monotonic: önce priority, sonra kısa periyot
+    TASK_DISPATCH_EDF,      // earliest deadline first: mutlak deadline'a göre
+} dispatch_policy_t;
+
+// Zaman kaynağı: monotonik, nanosaniye, 64-bit (taşma ~584 yıl)
+typedef uint64_t (*time_source_t)(void);
+
+// Bekleme hook'u: has_deadline false ise task yoktur, task_wakeup() beklenir
+typedef void (*idle_hook_t)(uint64_t wake_at_ns, bool has_deadline);
+
 typedef struct {
     callback_t cb;
-    unsigned int period_ms;
-    unsigned int last_run_ms;
+    uint64_t period_ns;
+    uint64_t last_run_ns;
+    uint64_t deadline_ns;   // göreli deadline, varsayılanı periyot
+    uint64_t wcet_ns;       // en kötü çalışma süresi tahmini, 0 ise bilinmiyor
+    unsigned int density_ppm; // wcet / min(deadline, period), milyonda
+    int priority;           // büyük olan önce, eşitlikte politika belirler
     bool is_enabled;
+    int heap_idx;           // task_heap içindeki yeri, heap'te değilse -1
+    catchup_policy_t catchup;
+    overlap_policy_t overlap;
+    atomic_int outstanding; // worker'da çalışan + kuyrukta bekleyen koşu sayısı
+    atomic_bool cancel_requested; // callback executor'da kendini sildi, scheduler bitirecek
 } task_t;
 
 static task_t tasks[TASK_COUNT];
 
+#if defined(__linux__)
+// Bu thread'de task_execute() içinde çalışan task, yoksa INVALID_TASK_ID
+static _Thread_local int g_running_task_id = INVALID_TASK_ID;
+#endif
+
+// Snapshot okurken yazanı durdurmamak için tüm alanlar relaxed atomic.
+// Bir alana aynı anda tek thread yazdığından artırma için RMW gerekmez.
+typedef struct {
+    atomic_uint runs;
+    atomic_uint skipped;        // SKIP politikasıyla atlanan periyotlar
+    atomic_uint queued;         // QUEUE politikasıyla ertelenen periyotlar
+    atomic_uint overruns;       // çalışma süresi periyodu aşan koşular
+    atomic_uint missed;         // catch-up politikasıyla düşürülen periyotlar
+    atomic_uint deadline_misses; // göreli deadline'ından sonra biten koşular
+    atomic_ullong release_ns;   // worker'a verilen koşunun planlanan zamanı
+    atomic_uint lateness_max_us;
+    atomic_uint exec_max_us;
+    atomic_uint lateness[HIST_BUCKETS];
+    atomic_uint exec_time[HIST_BUCKETS];
+} task_stats_t;
+
+// task_stats_snapshot() çıktısı, değerler mikro saniye
+typedef struct {
+    unsigned int runs;
+    unsigned int skipped;
+    unsigned int queued;
+    unsigned int overruns;
+    unsigned int missed;
+    unsigned int deadline_misses;
+    unsigned int lateness_max_us;
+    unsigned int exec_max_us;
+    unsigned int lateness[HIST_BUCKETS];
+    unsigned int exec_time[HIST_BUCKETS];
+} task_stats_snapshot_t;
+
+#if TASK_STATS_ENABLED
+static task_stats_t task_stats[TASK_COUNT];
+#endif
+
+// Boş task id'leri (stack olarak kullanılır)
+static int free_ids[TASK_COUNT];
+static int free_count = 0;
+
+// Bir sonraki çalışma zamanına (last_run_ns + period_ns) göre min-heap.
+// En erken task her zaman task_heap[0]'da durur.
+static int task_heap[TASK_COUNT];
+static int heap_size = 0;
+
+static dispatch_policy_t g_dispatch_policy = TASK_DISPATCH_FIFO;
+
+// WCET'i bilinen task'ların toplam yoğunluğu (milyonda), schedulability kontrolü için
+static unsigned long long g_total_density_ppm = 0;
+static int g_rt_task_count = 0;
+
+void task_wakeup(void);
+
+static void default_idle_hook(uint64_t wake_at_ns, bool has_deadline);
+static uint64_t default_time_source(void);
+
+static idle_hook_t g_idle_hook = default_idle_hook;
+static time_source_t g_time_source = default_time_source;
+
+#if defined(__linux__)
+
+// Linux'ta SysTick kesmesi yok, zaman CLOCK_MONOTONIC'ten okunur.
+// timerfd bir sonraki deadline'a kurulur, eventfd task_wakeup() için kullanılır.
+static int g_timer_fd = -1;
+static int g_wakeup_fd = -1;
+
+static uint64_t default_time_source(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+#else
+
+#define SYSTICK_PERIOD_NS 1000000ull
+
 // SysTick değişkeni volatile olmalı
-static volatile unsigned int g_system_ticks_ms = 0;
+static volatile uint64_t g_system_ticks = 0;
+static volatile bool g_wakeup_pending = false;
 
 // SysTick Kesme Servis Rutini (ISR) - 1ms'de bir çağrılır
 void systick_timer(void)
 {
-    g_system_ticks_ms++;
+    g_system_ticks++;
 }
 
 // Anlık zamanı güvenli okumak için yardımcı fonksiyon
-static unsigned int get_system_ticks(void)
+static uint64_t get_system_ticks(void)
+{
+    uint64_t first;
+    uint64_t second;
+
+    // 32-bit çekirdekte 64-bit okuma iki parçadır, arada kesme gelirse tekrar oku
+    do
+    {
+        first = g_system_ticks;
+        second = g_system_ticks;
+    } while (first != second);
+
+    return first;
+}
+
+static uint64_t default_time_source(void)
 {
-    // 32-bit okuma atomik kabul edilse de kesme anında tutarsızlığı önler
-    return g_system_ticks_ms; 
+    return get_system_ticks() * SYSTICK_PERIOD_NS;
 }
 
-void task_scheduler(void)
+#endif
+
+static uint64_t task_now_ns(void)
+{
+    return g_time_source();
+}
+
+// Hedefte daha hassas bir sayaç (ör. DWT->CYCCNT ya da bir donanım timer'ı) vermek için.
+// Task'lar kaydedilmeden önce çağrılmalı, NULL varsayılana döner.
+void task_set_time_source(time_source_t source)
+{
+    g_time_source = (source != NULL) ? source : default_time_source;
+}
+
+#if TASK_STATS_ENABLED
+
+static unsigned int hist_bucket(unsigned int value_us)
+{
+    if (value_us >= (1u << HIST_MAX_BITS))
+    {
+        return HIST_BUCKETS - 1;
+    }
+
+    if (value_us < 2 * HIST_SUB_COUNT)
+    {
+        return value_us;
+    }
+
+    unsigned int msb = 31u - (unsigned int)__builtin_clz(value_us);
+    unsigned int shift = msb - HIST_SUB_BITS;
+
+    return shift * HIST_SUB_COUNT + (value_us >> shift);
+}
+
+static void stat_add(atomic_uint *p_counter, unsigned int value)
+{
+    atomic_store_explicit(p_counter, atomic_load_explicit(p_counter, memory_order_relaxed) + value,
+                          memory_order_relaxed);
+}
+
+static void stat_inc(atomic_uint *p_counter)
+{
+    stat_add(p_counter, 1);
+}
+
+static void hist_record(atomic_uint *p_hist, atomic_uint *p_max, unsigned int value_us)
+{
+    stat_inc(&p_hist[hist_bucket(value_us)]);
+
+    if (value_us > atomic_load_explicit(p_max, memory_order_relaxed))
+    {
+        atomic_store_explicit(p_max, value_us, memory_order_relaxed);
+    }
+}
+
+static void task_stats_reset(int id)
+{
+    task_stats_t *p_stats = &task_stats[id];
+
+    atomic_store_explicit(&p_stats->runs, 0, memory_order_relaxed);
+    atomic_store_explicit(&p_stats->skipped, 0, memory_order_relaxed);
+    atomic_store_explicit(&p_stats->queued, 0, memory_order_relaxed);
+    atomic_store_explicit(&p_stats->overruns, 0, memory_order_relaxed);
+    atomic_store_explicit(&p_stats->missed, 0, memory_order_relaxed);
+    atomic_store_explicit(&p_stats->deadline_misses, 0, memory_order_relaxed);
+    atomic_store_explicit(&p_stats->lateness_max_us, 0, memory_order_relaxed);
+    atomic_store_explicit(&p_stats->exec_max_us, 0, memory_order_relaxed);
+
+    for (int i = 0; i < HIST_BUCKETS; i++)
+    {
+        atomic_store_explicit(&p_stats->lateness[i], 0, memory_order_relaxed);
+        atomic_store_explicit(&p_stats->exec_time[i], 0, memory_order_relaxed);
+    }
+}
+
+// Histogram sınırını aşan değerler son kovaya düşer, burada 32-bit'e kırpmak yeterli
+static unsigned int ns_to_us(uint64_t value_ns)
+{
+    uint64_t value_us = value_ns / 1000ull;
+    return (value_us > 0xFFFFFFFFull) ? 0xFFFFFFFFu : (unsigned int)value_us;
+}
+
+#endif
+
+// Callback'i çalıştırır ve istatistik açıksa gecikme/çalışma süresini kaydeder.
+// release_ns bu koşunun planlandığı zamandır.
+static void task_run(int id, uint64_t release_ns, bool record_lateness)
+{
+#if TASK_STATS_ENABLED
+    task_stats_t *p_stats = &task_stats[id];
+    uint64_t start_ns = task_now_ns();
+
+    if (record_lateness)
+    {
+        uint64_t late_ns = (start_ns > release_ns) ? start_ns - release_ns : 0;
+        hist_record(p_stats->lateness, &p_stats->lateness_max_us, ns_to_us(late_ns));
+    }
+
+    tasks[id].cb();
+
+    uint64_t end_ns = task_now_ns();
+    uint64_t exec_ns = end_ns - start_ns;
+
+    if (record_lateness && end_ns > release_ns + tasks[id].deadline_ns)
+    {
+        stat_inc(&p_stats->deadline_misses);
+    }
+
+    hist_record(p_stats->exec_time, &p_stats->exec_max_us, ns_to_us(exec_ns));
+    stat_inc(&p_stats->runs);
+
+    if (exec_ns >= tasks[id].period_ns)
+    {
+        stat_inc(&p_stats->overruns);
+    }
+#else
+    (void)release_ns;
+    (void)record_lateness;
+    tasks[id].cb();
+#endif
+}
+
+static uint64_t task_next_run(int id)
+{
+    return tasks[id].last_run_ns + tasks[id].period_ns;
+}
+
+// 64-bit nanosaniye pratikte taşmadığı için düz karşılaştırma yeterli
+static bool heap_less(int a, int b)
+{
+    return task_next_run(task_heap[a]) < task_next_run(task_heap[b]);
+}
+
+static void heap_swap(int a, int b)
 {
-    unsigned int current_time = get_system_ticks();
+    int tmp = task_heap[a];
+    task_heap[a] = task_heap[b];
+    task_heap[b] = tmp;
+
+    tasks[task_heap[a]].heap_idx = a;
+    tasks[task_heap[b]].heap_idx = b;
+}
 
-    for (int i = 0; i < TASK_COUNT; i++)
+static void heap_sift_up(int idx)
+{
+    while (idx > 0)
     {
-        if (!tasks[i].is_enabled || tasks[i].cb == NULL)
+        int parent = (idx - 1) / 2;
+
+        if (!heap_less(idx, parent))
         {
-            continue;
+            break;
+        }
+
+        heap_swap(idx, parent);
+        idx = parent;
+    }
+}
+
+static void heap_sift_down(int idx)
+{
+    while (1)
+    {
+        int left = 2 * idx + 1;
+        int right = left + 1;
+        int smallest = idx;
+
+        if (left < heap_size && heap_less(left, smallest))
+        {
+            smallest = left;
+        }
+
+        if (right < heap_size && heap_less(right, smallest))
+        {
+            smallest = right;
         }
 
-        // Unsigned çıkarma işlemi (current_time - last_run_ms) 
-        // integer overflow (taşma) durumunda dahi doğru farkı verir!
-        if ((current_time - tasks[i].last_run_ms) >= tasks[i].period_ms)
+        if (smallest == idx)
         {
-            // Zaman damgasını güncelle
-            // 'last_run_ms = current_time' yerine '+=' kullanmak zaman kaymasını (drift) önler.
-            tasks[i].last_run_ms += tasks[i].period_ms; 
-            
-            // Task callback fonksiyonunu çalıştır
-            tasks[i].cb();
+            break;
         }
+
+        heap_swap(idx, smallest);
+        idx = smallest;
     }
 }
 
-void task_1s_callback(void)
+static void heap_push(int id)
 {
-    printf("1000 ms task executed at %u ms\n", get_system_ticks());
+    task_heap[heap_size] = id;
+    tasks[id].heap_idx = heap_size;
+    heap_size++;
+    heap_sift_up(heap_size - 1);
 }
 
-void task_5ms_callback(void)
+static void heap_remove(int id)
 {
-    // Note: Printf 1ms kesme yapısında main loop'u yavaşlatabilir
-    // Gerçek sistemde burada pin toggle / sensör okuma yapılır.
+    int idx = tasks[id].heap_idx;
+
+    heap_size--;
+    if (idx != heap_size)
+    {
+        heap_swap(idx, heap_size);
+        heap_sift_up(idx);
+        heap_sift_down(tasks[task_heap[idx]].heap_idx);
+    }
+
+    tasks[id].heap_idx = -1;
 }
 
-void task_init(void)
+void task_table_init(void)
 {
-    // Task 0: 5ms period
-    tasks[0].cb = task_5ms_callback;
-    tasks[0].period_ms = 5;
-    tasks[0].last_run_ms = 0;
-    tasks[0].is_enabled = true;
-
-    // Task 1: 1000ms period
-    tasks[1].cb = task_1s_callback;
-    tasks[1].period_ms = 1000;
-    tasks[1].last_run_ms = 0;
-    tasks[1].is_enabled = true;
-    
-    // Diğer task'lar opsiyonel olarak initialize edilebilir
-    for(int i = 2; i < TASK_COUNT; i++)
+    heap_size = 0;
+    free_count = 0;
+
+    // Küçük id'ler önce verilsin diye ters sırada doldur
+    for (int i = TASK_COUNT - 1; i >= 0; i--)
     {
         tasks[i].cb = NULL;
         tasks[i].is_enabled = false;
+        tasks[i].heap_idx = -1;
+        atomic_init(&tasks[i].outstanding, 0);
+        atomic_init(&tasks[i].cancel_requested, false);
+        free_ids[free_count++] = i;
     }
 }
 
-int main(void)
+// Yeni periyodik task ekler, ilk çalışması şimdiden period_us sonra olur.
+// Task id'si ya da yer yoksa INVALID_TASK_ID döner.
+int task_register_us(callback_t cb, uint64_t period_us)
 {
-    task_init();
+    if (cb == NULL || period_us == 0 || free_count == 0)
+    {
+        return INVALID_TASK_ID;
+    }
 
-    while (1)
+    int id = free_ids[--free_count];
+
+    tasks[id].cb = cb;
+    tasks[id].period_ns = period_us * 1000ull;
+    tasks[id].last_run_ns = task_now_ns();
+    tasks[id].deadline_ns = tasks[id].period_ns;
+    tasks[id].wcet_ns = 0;
+    tasks[id].density_ppm = 0;
+    tasks[id].priority = 0;
+    tasks[id].is_enabled = true;
+    tasks[id].catchup = TASK_CATCHUP_ALL;
+    tasks[id].overlap = TASK_OVERLAP_SKIP;
+#if TASK_STATS_ENABLED
+    task_stats_reset(id);
+#endif
+    heap_push(id);
+
+    // Yeni task en erken deadline'a sahipse uyuyan scheduler'ı uyandır
+    if (task_heap[0] == id)
     {
-        task_scheduler();
+        task_wakeup();
     }
 
-    return 0;
-}
\ No newline at end of file
+    return id;
+}
+
+int task_register(callback_t cb, unsigned int period_ms)
+{
+    return task_register_us(cb, (uint64_t)period_ms * 1000ull);
+}
+
+// Task'ı siler. Callback'in içinden de (kendisi dahil) çağrılabilir.
+// Executor modunda ise scheduler thread'inden ya da task'ın kendi callback'inden
+// çağrılmalıdır. Kendi callback'i çalışırken outstanding sıfıra inemez, bu yüzden
+// istek işaretlenir ve silme task'ın bir sonraki vaktinde scheduler thread'inde
+// tamamlanır. O zamana kadar task bir daha çalışmaz.
+bool task_cancel(int id)
+{
+    if (id < 0 || id >= TASK_COUNT || tasks[id].cb == NULL)
+    {
+        return false;
+    }
+
+#if defined(__linux__)
+    if (g_running_task_id == id)
+    {
+        atomic_store_explicit(&tasks[id].cancel_requested, true, memory_order_release);
+        return true;
+    }
+#endif
+
+    if (tasks[id].heap_idx >= 0)
+    {
+        heap_remove(id);
+    }
+
+#if defined(__linux__)
+    // Worker'daki koşular bitmeden slot yeniden kullanılmasın
+    while (atomic_load_explicit(&tasks[id].outstanding, memory_order_acquire) > 0)
+    {
+        sched_yield();
+    }
+#endif
+
+    if (tasks[id].wcet_ns > 0)
+    {
+        g_total_density_ppm -= tasks[id].density_ppm;
+        g_rt_task_count--;
+    }
+
+    tasks[id].cb = NULL;
+    tasks[id].is_enabled = false;
+    atomic_store_explicit(&tasks[id].cancel_requested, false, memory_order_relaxed);
+    free_ids[free_count++] = id;
+
+    return true;
+}
+
+// Kapalı task heap'te durmaz, böylece scheduler onu hiç görmez
+bool task_set_enabled(int id, bool is_enabled)
+{
+    if (id < 0 || id >= TASK_COUNT || tasks[id].cb == NULL)
+    {
+        return false;
+    }
+
+    if (is_enabled && !tasks[id].is_enabled)
+    {
+        // Kaçırılan periyotları topluca çalıştırmamak için şimdiden başlat
+        tasks[id].last_run_ns = task_now_ns();
+        heap_push(id);
+
+        if (task_heap[0] == id)
+        {
+            task_wakeup();
+        }
+    }
+    else if (!is_enabled && tasks[id].is_enabled)
+    {
+        // Bu tick'te vadesi gelmiş task heap'ten çıkmış, due[] içinde bekliyor.
+        // Orada kapalı olduğu görülüp atlanır.
+        if (tasks[id].heap_idx >= 0)
+        {
+            heap_remove(id);
+        }
+    }
+
+    tasks[id].is_enabled = is_enabled;
+
+    return true;
+}
+
+bool task_set_catchup(int id, catchup_policy_t catchup)
+{
+    if (id < 0 || id >= TASK_COUNT || tasks[id].cb == NULL)
+    {
+        return false;
+    }
+
+    tasks[id].catchup = catchup;
+
+    return true;
+}
+
+// En erken deadline'ı verir, hiç aktif task yoksa false döner
+bool task_next_deadline(uint64_t *p_deadline_ns)
+{
+    if (heap_size == 0)
+    {
+        return false;
+    }
+
+    *p_deadline_ns = task_next_run(task_heap[0]);
+    return true;
+}
+
+// Hedefte WFI gibi düşük güç bekleme için kendi hook'unu ver, NULL varsayılana döner
+void task_set_idle_hook(idle_hook_t hook)
+{
+    g_idle_hook = (hook != NULL) ? hook : default_idle_hook;
+}
+
+#if defined(__linux__)
+
+static void idle_fds_init(void)
+{
+    if (g_wakeup_fd < 0)
+    {
+        g_wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    }
+
+    if (g_timer_fd < 0)
+    {
+        g_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    }
+}
+
+// Başka bir thread'den ya da sinyal handler'ından çağrılabilir (async-signal-safe).
+// Task tablosunun kendisi korumasızdır, başka thread'den task_register için kilit gerekir.
+void task_wakeup(void)
+{
+    if (g_wakeup_fd >= 0)
+    {
+        unsigned long long one = 1;
+        ssize_t ret = write(g_wakeup_fd, &one, sizeof(one));
+        (void)ret;
+    }
+}
+
+static void default_idle_hook(uint64_t wake_at_ns, bool has_deadline)
+{
+    uint64_t abs_ns = 0;
+
+    if (has_deadline)
+    {
+        uint64_t now_ns = task_now_ns();
+        if (wake_at_ns <= now_ns)
+        {
+            return;
+        }
+
+        // Zaman kaynağı değiştirilmiş olabilir, kalan süreyi CLOCK_MONOTONIC'e taşı
+        abs_ns = default_time_source() + (wake_at_ns - now_ns);
+    }
+
+    idle_fds_init();
+
+    struct timespec abs_ts;
+    abs_ts.tv_sec = (time_t)(abs_ns / 1000000000ull);
+    abs_ts.tv_nsec = (long)(abs_ns % 1000000000ull);
+
+    if (g_timer_fd < 0 || g_wakeup_fd < 0)
+    {
+        // fd açılamadıysa uyandırılamayan ama yine de boşta bekleyen yol
+        if (has_deadline)
+        {
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &abs_ts, NULL) == EINTR)
+            {
+            }
+        }
+        return;
+    }
+
+    // Deadline yoksa timer kapalı kalır (it_value sıfır), sadece wakeup beklenir
+    struct itimerspec its = {{0, 0}, {0, 0}};
+    if (has_deadline)
+    {
+        its.it_value = abs_ts;
+    }
+    timerfd_settime(g_timer_fd, TFD_TIMER_ABSTIME, &its, NULL);
+
+    struct pollfd fds[2] = {
+        { .fd = g_timer_fd, .events = POLLIN },
+        { .fd = g_wakeup_fd, .events = POLLIN },
+    };
+
+    if (poll(fds, 2, -1) > 0)
+    {
+        unsigned long long count;
+        ssize_t ret;
+
+        if (fds[0].revents & POLLIN)
+        {
+            ret = read(g_timer_fd, &count, sizeof(count));
+        }
+        if (fds[1].revents & POLLIN)
+        {
+            ret = read(g_wakeup_fd, &count, sizeof(count));
+        }
+        (void)ret;
+    }
+}
+
+#else
+
+// Kesmeden de çağrılabilir
+void task_wakeup(void)
+{
+    g_wakeup_pending = true;
+}
+
+// SysTick her 1ms'de çekirdeği uyandırır, bu yüzden WFI'dan sonra tekrar kontrol yeter
+static void default_idle_hook(uint64_t wake_at_ns, bool has_deadline)
+{
+    while (!g_wakeup_pending)
+    {
+        if (has_deadline && task_now_ns() >= wake_at_ns)
+        {
+            break;
+        }
+#if defined(__arm__) || defined(__aarch64__)
+        __asm volatile ("wfi");
+#endif
+    }
+
+    g_wakeup_pending = false;
+}
+
+#endif
+
+// Bir sonraki deadline'a kadar (ya da task_wakeup() gelene kadar) bekler
+void task_idle(void)
+{
+    uint64_t deadline_ns = 0;
+    bool has_deadline = task_next_deadline(&deadline_ns);
+
+    g_idle_hook(deadline_ns, has_deadline);
+}
+
+bool task_set_overlap(int id, overlap_policy_t overlap)
+{
+    if (id < 0 || id >= TASK_COUNT || tasks[id].cb == NULL)
+    {
+        return false;
+    }
+
+    tasks[id].overlap = overlap;
+
+    return true;
+}
+
+#if defined(__linux__)
+
+#define TASK_MAX_WORKERS 16
+#define WORKER_DEQUE_SIZE 1024      // 2'nin kuvveti olmalı
+
+// Chase-Lev deque. Tek yazan scheduler thread'i bottom'a ekler, worker'lar
+// (sahibi dahil) top'tan CAS ile çalar. Sahibi pop yapmadığı için son eleman
+// üzerinde sahip/hırsız yarışı olmaz.
+typedef struct {
+    _Alignas(CACHE_LINE_SIZE) atomic_long top;
+    _Alignas(CACHE_LINE_SIZE) atomic_long bottom;
+    atomic_int items[WORKER_DEQUE_SIZE];
+} worker_deque_t;
+
+static worker_deque_t g_deques[TASK_MAX_WORKERS];
+static pthread_t g_workers[TASK_MAX_WORKERS];
+static int g_worker_count = 0;
+static int g_next_worker = 0;
+static atomic_bool g_executor_stop;
+
+// Sayacı deque'lerdeki iş sayısına eşittir, boşta kalan worker'lar burada uyur
+static sem_t g_work_sem;
+
+static bool deque_push(worker_deque_t *p_deque, int id)
+{
+    long b = atomic_load_explicit(&p_deque->bottom, memory_order_relaxed);
+    long t = atomic_load_explicit(&p_deque->top, memory_order_acquire);
+
+    if (b - t >= WORKER_DEQUE_SIZE)
+    {
+        return false;
+    }
+
+    atomic_store_explicit(&p_deque->items[b & (WORKER_DEQUE_SIZE - 1)], id, memory_order_relaxed);
+    atomic_store_explicit(&p_deque->bottom, b + 1, memory_order_release);
+
+    return true;
+}
+
+static bool deque_steal(worker_deque_t *p_deque, int *p_id)
+{
+    long t = atomic_load_explicit(&p_deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long b = atomic_load_explicit(&p_deque->bottom, memory_order_acquire);
+
+    if (t >= b)
+    {
+        return false;
+    }
+
+    // Slot ancak top ilerledikten sonra üzerine yazılabilir, o zaman da CAS başarısız olur
+    int id = atomic_load_explicit(&p_deque->items[t & (WORKER_DEQUE_SIZE - 1)], memory_order_relaxed);
+
+    if (!atomic_compare_exchange_strong_explicit(&p_deque->top, &t, t + 1,
+                                                 memory_order_seq_cst, memory_order_relaxed))
+    {
+        return false;
+    }
+
+    *p_id = id;
+    return true;
+}
+
+// Önce kendi deque'ine, sonra sırayla diğerlerine bakar
+static bool worker_take(int self, int *p_id)
+{
+    for (int i = 0; i < g_worker_count; i++)
+    {
+        if (deque_steal(&g_deques[(self + i) % g_worker_count], p_id))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// QUEUE politikasında bekleyen koşular aynı thread'de art arda çalışır,
+// böylece bir task asla kendisiyle paralel çalışmaz.
+static void task_execute(int id)
+{
+    uint64_t release_ns = 0;
+    bool record_lateness = true;
+
+#if TASK_STATS_ENABLED
+    release_ns = atomic_load_explicit(&task_stats[id].release_ns, memory_order_relaxed);
+#endif
+
+    int previous_id = g_running_task_id;
+    g_running_task_id = id;
+
+    // Kuyruktan gelen tekrar koşuların planlanan zamanı yok, gecikmeleri queued sayacında
+    do
+    {
+        // Callback kendini sildiyse kuyrukta bekleyen koşular çalışmaz
+        if (!atomic_load_explicit(&tasks[id].cancel_requested, memory_order_acquire))
+        {
+            task_run(id, release_ns, record_lateness);
+        }
+        record_lateness = false;
+    } while (atomic_fetch_sub_explicit(&tasks[id].outstanding, 1, memory_order_acq_rel) > 1);
+
+    g_running_task_id = previous_id;
+}
+
+static void *worker_main(void *arg)
+{
+    int self = (int)(intptr_t)arg;
+    int id;
+
+    while (1)
+    {
+        while (sem_wait(&g_work_sem) != 0 && errno == EINTR)
+        {
+        }
+
+        // Semafor bir işin var olduğunu garanti eder, başka worker kapmışsa tekrar dene
+        while (!worker_take(self, &id))
+        {
+            if (atomic_load_explicit(&g_executor_stop, memory_order_acquire))
+            {
+                return NULL;
+            }
+            sched_yield();
+        }
+
+        task_execute(id);
+    }
+}
+
+static void task_dispatch(int id)
+{
+    if (tasks[id].overlap == TASK_OVERLAP_SKIP)
+    {
+        int expected = 0;
+        if (!atomic_compare_exchange_strong_explicit(&tasks[id].outstanding, &expected, 1,
+                                                     memory_order_acq_rel, memory_order_relaxed))
+        {
+            // Önceki koşu hala sürüyor, bu periyot atlanır
+#if TASK_STATS_ENABLED
+            stat_inc(&task_stats[id].skipped);
+#endif
+            return;
+        }
+    }
+    else if (atomic_fetch_add_explicit(&tasks[id].outstanding, 1, memory_order_acq_rel) > 0)
+    {
+        // Çalıştıran worker bitirince bir kez daha çalıştıracak
+#if TASK_STATS_ENABLED
+        stat_inc(&task_stats[id].queued);
+#endif
+        return;
+    }
+
+#if TASK_STATS_ENABLED
+    // deque_push'un release'i bu değeri worker'a görünür kılar
+    atomic_store_explicit(&task_stats[id].release_ns, tasks[id].last_run_ns, memory_order_relaxed);
+#endif
+
+    for (int i = 0; i < g_worker_count; i++)
+    {
+        int w = g_next_worker;
+        g_next_worker = (g_next_worker + 1) % g_worker_count;
+
+        if (deque_push(&g_deques[w], id))
+        {
+            sem_post(&g_work_sem);
+            return;
+        }
+    }
+
+    // Tüm deque'ler doluysa scheduler thread'inde çalıştır
+    task_execute(id);
+}
+
+// Callback'ler artık scheduler thread'i yerine worker_count adet thread'de çalışır.
+// Bu modda task_register / task_cancel sadece scheduler thread'inden çağrılmalıdır.
+// Tek istisna, bir callback'in kendi task'ını task_cancel ile silmesidir.
+bool task_executor_start(int worker_count)
+{
+    if (g_worker_count > 0 || worker_count < 1 || worker_count > TASK_MAX_WORKERS)
+    {
+        return false;
+    }
+
+    if (sem_init(&g_work_sem, 0, 0) != 0)
+    {
+        return false;
+    }
+
+    atomic_store(&g_executor_stop, false);
+    g_next_worker = 0;
+
+    for (int i = 0; i < worker_count; i++)
+    {
+        atomic_store(&g_deques[i].top, 0);
+        atomic_store(&g_deques[i].bottom, 0);
+    }
+
+    // worker_take, g_worker_count'u okuduğu için thread'lerden önce ayarlanır
+    g_worker_count = worker_count;
+
+    for (int i = 0; i < worker_count; i++)
+    {
+        if (pthread_create(&g_workers[i], NULL, worker_main, (void *)(intptr_t)i) != 0)
+        {
+            atomic_store(&g_executor_stop, true);
+            for (int j = 0; j < i; j++)
+            {
+                sem_post(&g_work_sem);
+            }
+            for (int j = 0; j < i; j++)
+            {
+                pthread_join(g_workers[j], NULL);
+            }
+            g_worker_count = 0;
+            sem_destroy(&g_work_sem);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Worker'ları durdurur, deque'lerde kalan işleri çağıran thread'de bitirir
+void task_executor_stop(void)
+{
+    int id;
+
+    if (g_worker_count == 0)
+    {
+        return;
+    }
+
+    atomic_store_explicit(&g_executor_stop, true, memory_order_release);
+    for (int i = 0; i < g_worker_count; i++)
+    {
+        sem_post(&g_work_sem);
+    }
+
+    for (int i = 0; i < g_worker_count; i++)
+    {
+        pthread_join(g_workers[i], NULL);
+    }
+
+    while (worker_take(0, &id))
+    {
+        task_execute(id);
+    }
+
+    g_worker_count = 0;
+    sem_destroy(&g_work_sem);
+}
+
+#endif
+
+// Liu & Layland RM sınırı n * (2^(1/n) - 1), milyonda. n büyüdükçe ln 2'ye yaklaşır.
+static unsigned int rm_bound_ppm(int n)
+{
+    static const unsigned int bounds[] = {
+        1000000, 1000000, 828427, 779763, 756828, 743492, 734772, 728627, 724062, 720538, 717735,
+    };
+
+    return (n < (int)(sizeof(bounds) / sizeof(bounds[0]))) ? bounds[n] : 693147;
+}
+
+// Toplam yoğunluk kapasiteyi aşıyorsa uyarır. EDF ve FIFO için sınır çekirdek
+// başına 1, RM için Liu & Layland sınırıdır (yeterli koşul, aşılması kesin kaçırma
+// anlamına gelmez). Executor açıksa kapasite worker sayısıyla çarpılır.
+bool task_check_schedulability(void)
+{
+    unsigned long long cores = 1;
+
+#if defined(__linux__)
+    if (g_worker_count > 0)
+    {
+        cores = (unsigned long long)g_worker_count;
+    }
+#endif
+
+    unsigned long long bound_ppm = (g_dispatch_policy == TASK_DISPATCH_RM) ? rm_bound_ppm(g_rt_task_count) : 1000000;
+    unsigned long long capacity_ppm = bound_ppm * cores;
+
+    if (g_total_density_ppm > capacity_ppm)
+    {
+        printf("warning: task utilization %llu.%02llu%% exceeds %llu.%02llu%% capacity\n",
+               g_total_density_ppm / 10000, (g_total_density_ppm / 100) % 100,
+               capacity_ppm / 10000, (capacity_ppm / 100) % 100);
+        return false;
+    }
+
+    return true;
+}
+
+// Öncelik, göreli deadline ve WCET verir. deadline_us 0 ise periyot kullanılır,
+// wcet_us 0 ise task schedulability hesabına katılmaz. Kapasite aşılırsa uyarır
+// ama ayarları yine de uygular.
+bool task_set_timing(int id, int priority, uint64_t deadline_us, uint64_t wcet_us)
+{
+    if (id < 0 || id >= TASK_COUNT || tasks[id].cb == NULL)
+    {
+        return false;
+    }
+
+    if (tasks[id].wcet_ns > 0)
+    {
+        g_total_density_ppm -= tasks[id].density_ppm;
+        g_rt_task_count--;
+    }
+
+    tasks[id].priority = priority;
+    tasks[id].deadline_ns = (deadline_us > 0) ? deadline_us * 1000ull : tasks[id].period_ns;
+    tasks[id].wcet_ns = wcet_us * 1000ull;
+    tasks[id].density_ppm = 0;
+
+    if (tasks[id].wcet_ns > 0)
+    {
+        uint64_t window_ns = (tasks[id].deadline_ns < tasks[id].period_ns) ? tasks[id].deadline_ns : tasks[id].period_ns;
+        uint64_t density_ppm = (tasks[id].wcet_ns * 1000000ull) / window_ns;
+
+        tasks[id].density_ppm = (density_ppm > 0xFFFFFFFFull) ? 0xFFFFFFFFu : (unsigned int)density_ppm;
+        g_total_density_ppm += tasks[id].density_ppm;
+        g_rt_task_count++;
+    }
+
+    task_check_schedulability();
+
+    return true;
+}
+
+// task_register_us + task_set_timing, task id'si ya da INVALID_TASK_ID döner
+int task_register_rt(callback_t cb, uint64_t period_us, uint64_t deadline_us, uint64_t wcet_us, int priority)
+{
+    int id = task_register_us(cb, period_us);
+
+    if (id != INVALID_TASK_ID)
+    {
+        task_set_timing(id, priority, deadline_us, wcet_us);
+    }
+
+    return id;
+}
+
+void task_set_dispatch_policy(dispatch_policy_t policy)
+{
+    g_dispatch_policy = policy;
+    task_check_schedulability();
+}
+
+#if TASK_STATS_ENABLED
+
+// Scheduler ve worker'lar çalışmaya devam ederken kopya alır. Alanlar tek tek
+// tutarlıdır ama aralarında birkaç koşuluk fark olabilir.
+bool task_stats_snapshot(int id, task_stats_snapshot_t *p_out)
+{
+    if (id < 0 || id >= TASK_COUNT || tasks[id].cb == NULL || p_out == NULL)
+    {
+        return false;
+    }
+
+    task_stats_t *p_stats = &task_stats[id];
+
+    p_out->runs = atomic_load_explicit(&p_stats->runs, memory_order_relaxed);
+    p_out->skipped = atomic_load_explicit(&p_stats->skipped, memory_order_relaxed);
+    p_out->queued = atomic_load_explicit(&p_stats->queued, memory_order_relaxed);
+    p_out->overruns = atomic_load_explicit(&p_stats->overruns, memory_order_relaxed);
+    p_out->missed = atomic_load_explicit(&p_stats->missed, memory_order_relaxed);
+    p_out->deadline_misses = atomic_load_explicit(&p_stats->deadline_misses, memory_order_relaxed);
+    p_out->lateness_max_us = atomic_load_explicit(&p_stats->lateness_max_us, memory_order_relaxed);
+    p_out->exec_max_us = atomic_load_explicit(&p_stats->exec_max_us, memory_order_relaxed);
+
+    for (int i = 0; i < HIST_BUCKETS; i++)
+    {
+        p_out->lateness[i] = atomic_load_explicit(&p_stats->lateness[i], memory_order_relaxed);
+        p_out->exec_time[i] = atomic_load_explicit(&p_stats->exec_time[i], memory_order_relaxed);
+    }
+
+    return true;
+}
+
+// Histogramdan yüzdelik değer (us) döner, per_mille 990 ise p99.
+// Değer, ilgili kovanın üst sınırıdır.
+unsigned int task_hist_percentile(const unsigned int *p_hist, unsigned int per_mille)
+{
+    unsigned long long total = 0;
+
+    for (int i = 0; i < HIST_BUCKETS; i++)
+    {
+        total += p_hist[i];
+    }
+
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    unsigned long long target = (total * per_mille + 999) / 1000;
+    unsigned long long seen = 0;
+    unsigned int idx = 0;
+
+    if (target == 0)
+    {
+        target = 1;
+    }
+
+    for (idx = 0; idx < HIST_BUCKETS - 1; idx++)
+    {
+        seen += p_hist[idx];
+        if (seen >= target)
+        {
+            break;
+        }
+    }
+
+    if (idx < 2 * HIST_SUB_COUNT)
+    {
+        return idx;
+    }
+
+    unsigned int shift = idx / HIST_SUB_COUNT - 1;
+    unsigned int lower = (idx % HIST_SUB_COUNT + HIST_SUB_COUNT) << shift;
+
+    return lower + (1u << shift) - 1;
+}
+
+void task_stats_print(int id)
+{
+    task_stats_snapshot_t snap;
+
+    if (!task_stats_snapshot(id, &snap))
+    {
+        return;
+    }
+
+    printf("task %d: runs %u skipped %u queued %u overruns %u missed %u deadline misses %u\n",
+           id, snap.runs, snap.skipped, snap.queued, snap.overruns, snap.missed, snap.deadline_misses);
+    printf("  lateness us  p50 %u p99 %u max %u\n",
+           task_hist_percentile(snap.lateness, 500), task_hist_percentile(snap.lateness, 990),
+           snap.lateness_max_us);
+    printf("  exec us      p50 %u p99 %u max %u\n",
+           task_hist_percentile(snap.exec_time, 500), task_hist_percentile(snap.exec_time, 990),
+           snap.exec_max_us);
+}
+
+#endif
+
+// Vadesi gelen task'ları seçili politikaya göre sıralar. Eşitlikte planlanan
+// zaman, o da eşitse id belirler (qsort kararlı değildir). Task'lar henüz
+// çalışmadığından task_next_run() hâlâ bu turun planlanan zamanını verir.
+static int due_compare(const void *p_a, const void *p_b)
+{
+    int id_a = *(const int *)p_a;
+    int id_b = *(const int *)p_b;
+    const task_t *p_ta = &tasks[id_a];
+    const task_t *p_tb = &tasks[id_b];
+    uint64_t release_a = task_next_run(id_a);
+    uint64_t release_b = task_next_run(id_b);
+
+    if (g_dispatch_policy == TASK_DISPATCH_EDF)
+    {
+        uint64_t deadline_a = release_a + p_ta->deadline_ns;
+        uint64_t deadline_b = release_b + p_tb->deadline_ns;
+
+        if (deadline_a != deadline_b)
+        {
+            return (deadline_a < deadline_b) ? -1 : 1;
+        }
+    }
+
+    if (p_ta->priority != p_tb->priority)
+    {
+        return (p_ta->priority > p_tb->priority) ? -1 : 1;
+    }
+
+    if (g_dispatch_policy == TASK_DISPATCH_RM && p_ta->period_ns != p_tb->period_ns)
+    {
+        return (p_ta->period_ns < p_tb->period_ns) ? -1 : 1;
+    }
+
+    if (release_a != release_b)
+    {
+        return (release_a < release_b) ? -1 : 1;
+    }
+
+    return (id_a < id_b) ? -1 : (id_a > id_b);
+}
+
+// Bir tick'te maliyet O(vadesi gelen task sayısı * log n), tüm task'ları dolaşmaz
+void task_scheduler(void)
+{
+    // TASK_COUNT kadar id tutar, hedefte varsayılan küçük olduğundan az yer kaplar
+    static int due[TASK_COUNT];
+    int due_count = 0;
+    uint64_t current_time = task_now_ns();
+
+    // Önce vadesi gelenleri heap'ten çıkar. Böylece geride kalan bir task
+    // eskisi gibi her çağrıda en fazla bir kez çalışır.
+    while (heap_size > 0 && task_next_run(task_heap[0]) <= current_time)
+    {
+        int id = task_heap[0];
+        due[due_count++] = id;
+        heap_remove(id);
+    }
+
+    // Heap zaten planlanan zamana göre verdiği için FIFO'da sıralama gerekmez
+    if (g_dispatch_policy != TASK_DISPATCH_FIFO && due_count > 1)
+    {
+        qsort(due, (size_t)due_count, sizeof(due[0]), due_compare);
+    }
+
+    for (int i = 0; i < due_count; i++)
+    {
+        int id = due[i];
+
+        // Daha önceki bir callback bu task'ı silmiş ya da kapatmış olabilir
+        if (tasks[id].cb == NULL || !tasks[id].is_enabled || tasks[id].heap_idx >= 0)
+        {
+            continue;
+        }
+
+#if defined(__linux__)
+        // Callback'i executor'da kendini silmek istedi, silme burada tamamlanır.
+        // task_cancel o koşunun bitmesini bekler.
+        if (atomic_load_explicit(&tasks[id].cancel_requested, memory_order_acquire))
+        {
+            task_cancel(id);
+            continue;
+        }
+#endif
+
+        // Zaman damgasını güncelle
+        // 'last_run_ns = current_time' yerine '+=' kullanmak zaman kaymasını (drift) önler.
+        tasks[id].last_run_ns += tasks[id].period_ns;
+
+        // Bir sonraki periyot da vadesini doldurduysa task geride kalmıştır
+        uint64_t missed = (current_time - tasks[id].last_run_ns) / tasks[id].period_ns;
+
+        if (missed > 0 && tasks[id].catchup != TASK_CATCHUP_ALL)
+        {
+            if (tasks[id].catchup == TASK_CATCHUP_SKIP)
+            {
+                tasks[id].last_run_ns += missed * tasks[id].period_ns;
+            }
+            else
+            {
+                tasks[id].last_run_ns = current_time;
+            }
+
+#if TASK_STATS_ENABLED
+            stat_add(&task_stats[id].missed, (missed > 0xFFFFFFFFull) ? 0xFFFFFFFFu : (unsigned int)missed);
+#endif
+        }
+
+        heap_push(id);
+
+#if defined(__linux__)
+        // Executor açıksa scheduler thread'i sadece zamanlamayı yapar
+        if (g_worker_count > 0)
+        {
+            task_dispatch(id);
+            continue;
+        }
+#endif
+
+        // Task callback fonksiyonunu çalıştır
+        task_run(id, tasks[id].last_run_ns, true);
+    }
+}
+
+// Simüle zaman: saat sadece task_sim_advance / task_sim_run_until ile ilerler,
+// böylece haftalarca sürecek bir çizelge gerçek bekleme olmadan test edilebilir.
+// Bu modda callback'ler inline çalışmalıdır (executor kapalı).
+static uint64_t g_sim_now_ns = 0;
+static time_source_t g_saved_time_source = NULL;
+static idle_hook_t g_saved_idle_hook = NULL;
+
+static uint64_t sim_time_source(void)
+{
+    return g_sim_now_ns;
+}
+
+// task_idle() simüle modda beklemek yerine saati bir sonraki deadline'a atlatır
+static void sim_idle_hook(uint64_t wake_at_ns, bool has_deadline)
+{
+    if (has_deadline && wake_at_ns > g_sim_now_ns)
+    {
+        g_sim_now_ns = wake_at_ns;
+    }
+}
+
+// Task'lar kaydedilmeden önce çağrılmalı
+void task_sim_enable(uint64_t start_ns)
+{
+    if (g_time_source != sim_time_source)
+    {
+        g_saved_time_source = g_time_source;
+        g_saved_idle_hook = g_idle_hook;
+        g_time_source = sim_time_source;
+        g_idle_hook = sim_idle_hook;
+    }
+
+    g_sim_now_ns = start_ns;
+}
+
+void task_sim_disable(void)
+{
+    if (g_time_source == sim_time_source)
+    {
+        g_time_source = g_saved_time_source;
+        g_idle_hook = g_saved_idle_hook;
+    }
+}
+
+// Callback içinden çağrılırsa callback'in çalışma süresini modellemiş olur
+void task_sim_advance(uint64_t delta_ns)
+{
+    g_sim_now_ns += delta_ns;
+}
+
+// Saati deadline'dan deadline'a atlatarak çizelgeyi end_ns'e kadar koşturur
+void task_sim_run_until(uint64_t end_ns)
+{
+    uint64_t deadline_ns;
+
+    while (1)
+    {
+        task_scheduler();
+
+        if (!task_next_deadline(&deadline_ns) || deadline_ns > end_ns)
+        {
+            if (g_sim_now_ns < end_ns)
+            {
+                g_sim_now_ns = end_ns;
+            }
+            return;
+        }
+
+        // Geride kalan task varsa deadline geçmiştir, saat geri alınmaz
+        if (deadline_ns > g_sim_now_ns)
+        {
+            g_sim_now_ns = deadline_ns;
+        }
+    }
+}
+
+void task_1s_callback(void)
+{
+    printf("1000 ms task executed at %llu ms\n", (unsigned long long)(task_now_ns() / 1000000ull));
+
+#if TASK_STATS_ENABLED
+    // 5ms task'ın (id 0) gecikme ve çalışma süresi dağılımı
+    task_stats_print(0);
+#endif
+}
+
+void task_5ms_callback(void)
+{
+    // Note: Printf 1ms kesme yapısında main loop'u yavaşlatabilir
+    // Gerçek sistemde burada pin toggle / sensör okuma yapılır.
+}
+
+void task_init(void)
+{
+    task_table_init();
+
+    // Sıkı periyotlu task yavaş 1s task'ın arkasında beklemesin
+    task_set_dispatch_policy(TASK_DISPATCH_EDF);
+
+    // Task 0: 5ms period, ~50us WCET
+    task_register_rt(task_5ms_callback, 5000, 0, 50, 0);
+
+    // Task 1: 1000ms period, printf yüzünden ~2ms WCET
+    task_register_rt(task_1s_callback, 1000000, 0, 2000, 0);
+
+    // Diğer task'lar çalışırken task_register / task_cancel ile eklenip çıkarılabilir
+}
+
+#ifdef TASK_SCHEDULER_TEST
+// Regresyon testleri, -DTASK_SCHEDULER_TEST ile derlenince demo yerine çalışır.
+// Kontroller NDEBUG ile de açık kalır.
+#define TEST_CHECK(cond) \
+    do \
+    { \
+        if (!(cond)) \
+        { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            return 1; \
+        } \
+    } while (0)
+
+static int g_test_b_id = -1;
+static int g_test_b_runs = 0;
+
+static void test_disable_b_callback(void)
+{
+    task_set_enabled(g_test_b_id, false);
+}
+
+static void test_b_callback(void)
+{
+    g_test_b_runs++;
+}
+
+#if defined(__linux__)
+static int g_test_self_cancel_id = -1;
+static atomic_int g_test_self_cancel_runs;
+
+static void test_self_cancel_callback(void)
+{
+    atomic_fetch_add(&g_test_self_cancel_runs, 1);
+    task_cancel(g_test_self_cancel_id);
+}
+#endif
+
+int main(void)
+{
+    // Aynı tick'te vadesi gelmiş bir task'ı başka bir callback kapatır.
+    // B zaten due[] içindedir (heap_idx == -1), heap'e dokunulmamalı.
+    task_table_init();
+    task_sim_enable(0);
+
+    int a_id = task_register_us(test_disable_b_callback, 9000);
+    g_test_b_id = task_register_us(test_b_callback, 10000);
+    TEST_CHECK(a_id >= 0 && g_test_b_id >= 0);
+
+    task_sim_advance(10000000ull);
+    task_scheduler();
+
+    TEST_CHECK(g_test_b_runs == 0);
+    TEST_CHECK(!tasks[g_test_b_id].is_enabled && tasks[g_test_b_id].heap_idx < 0);
+    TEST_CHECK(heap_size == 1 && task_heap[0] == a_id);
+
+    // Tekrar açılınca B normal çizelgesine döner
+    TEST_CHECK(task_cancel(a_id));
+    TEST_CHECK(task_set_enabled(g_test_b_id, true));
+    task_sim_run_until(30000000ull);
+    TEST_CHECK(g_test_b_runs == 2);
+
+    task_sim_disable();
+
+#if defined(__linux__)
+    // Executor'da kendini silen callback worker'ını kilitlememeli
+    task_table_init();
+    g_test_self_cancel_runs = 0;
+    g_test_self_cancel_id = task_register_us(test_self_cancel_callback, 1000);
+    TEST_CHECK(g_test_self_cancel_id >= 0);
+    TEST_CHECK(task_executor_start(2));
+
+    // Silinince heap boşalır ve task_idle() deadline'sız bekler, önce kontrol et
+    for (int i = 0; i < 1000; i++)
+    {
+        task_scheduler();
+
+        if (tasks[g_test_self_cancel_id].cb == NULL)
+        {
+            break;
+        }
+
+        task_idle();
+    }
+
+    TEST_CHECK(tasks[g_test_self_cancel_id].cb == NULL);
+    TEST_CHECK(atomic_load(&g_test_self_cancel_runs) == 1);
+    task_executor_stop();
+#endif
+
+    printf("task scheduler tests ok\n");
+
+    return 0;
+}
+#else
+int main(void)
+{
+    task_init();
+
+#if defined(__linux__)
+    // Yavaş bir callback diğer task'ları geciktirmesin
+    task_executor_start(2);
+#endif
+
+    while (1)
+    {
+        task_scheduler();
+
+        // Sıradaki task'ın zamanına kadar çekirdeği boşa çevirme
+        task_idle();
+    }
+
+    return 0;
+}
+#endif
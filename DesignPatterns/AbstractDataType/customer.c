@@ -1,30 +1,253 @@
-
 #include "stdio.h"
 #include "stdlib.h"
 #include "stdbool.h"
+#include "stdint.h"
+#include "string.h"
+#include "assert.h"
 #include "customer.h"
 
-#define MAX_NO_OF_ORDERS 50
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
-typedef struct {
-    const char *name;
+#define ORDER_STORE_ALIGNMENT 64
+#define ORDER_STORE_INITIAL_CAPACITY 1024
+#define ORDER_NONE UINT32_MAX
+#define CUSTOMER_NONE UINT32_MAX
+
+struct customer_t {
+    char *p_name;
     address_t address;
+    uint32_t id;
+    uint32_t last_order;    // Row of the newest order in the order store
     size_t no_of_orders;
-    order_t orders[MAX_NO_OF_ORDERS];
-} customer_t;
+};
+
+// Orders of all customers live in one columnar store, one contiguous array
+// per field, so an aggregate only streams through the columns it reads.
+// Each customer chains its own rows through p_prev_order.
+typedef struct {
+    size_t count;               // Rows in use, dead rows included
+    size_t capacity;
+    size_t dead;                // Rows released by customer_pop_last_order
+    uint32_t *p_order_id;
+    uint32_t *p_quantity;
+    int64_t *p_amount_cents;    // Zero for dead rows, so sums need no mask
+    uint32_t *p_customer_id;    // CUSTOMER_NONE for dead rows
+    uint32_t *p_prev_order;     // Previous row of the same customer or ORDER_NONE
+    customer_t **pp_customers;  // Indexed by customer id, NULL once destroyed
+    size_t no_of_customers;
+    size_t customers_capacity;
+} order_store_t;
+
+static order_store_t g_orders;
+
+static char *copy_name(const char *p_name)
+{
+    size_t len = strlen(p_name) + 1;
+    char *p_copy = malloc(len);
+
+    if(p_copy)
+    {
+        memcpy(p_copy, p_name, len);
+    }
+
+    return p_copy;
+}
+
+// Columns are cache line aligned so the kernels below can use aligned loads
+static void *column_alloc(const void *p_old, size_t elem_size, size_t count, size_t capacity)
+{
+    void *p_column = aligned_alloc(ORDER_STORE_ALIGNMENT, elem_size * capacity);
+
+    if(p_column && p_old)
+    {
+        memcpy(p_column, p_old, elem_size * count);
+    }
+
+    return p_column;
+}
+
+static bool order_store_grow(void)
+{
+    size_t capacity = g_orders.capacity ? g_orders.capacity * 2 : ORDER_STORE_INITIAL_CAPACITY;
+
+    // Rows are addressed with 32 bits and ORDER_NONE is reserved
+    if(capacity > ORDER_NONE)
+    {
+        capacity = ORDER_NONE;
+    }
+
+    if(capacity <= g_orders.count)
+    {
+        return false;
+    }
+
+    uint32_t *p_order_id = column_alloc(g_orders.p_order_id, sizeof(uint32_t), g_orders.count, capacity);
+    uint32_t *p_quantity = column_alloc(g_orders.p_quantity, sizeof(uint32_t), g_orders.count, capacity);
+    int64_t *p_amount_cents = column_alloc(g_orders.p_amount_cents, sizeof(int64_t), g_orders.count, capacity);
+    uint32_t *p_customer_id = column_alloc(g_orders.p_customer_id, sizeof(uint32_t), g_orders.count, capacity);
+    uint32_t *p_prev_order = column_alloc(g_orders.p_prev_order, sizeof(uint32_t), g_orders.count, capacity);
+
+    if(!p_order_id || !p_quantity || !p_amount_cents || !p_customer_id || !p_prev_order)
+    {
+        free(p_order_id);
+        free(p_quantity);
+        free(p_amount_cents);
+        free(p_customer_id);
+        free(p_prev_order);
+        return false;
+    }
+
+    free(g_orders.p_order_id);
+    free(g_orders.p_quantity);
+    free(g_orders.p_amount_cents);
+    free(g_orders.p_customer_id);
+    free(g_orders.p_prev_order);
+
+    g_orders.p_order_id = p_order_id;
+    g_orders.p_quantity = p_quantity;
+    g_orders.p_amount_cents = p_amount_cents;
+    g_orders.p_customer_id = p_customer_id;
+    g_orders.p_prev_order = p_prev_order;
+    g_orders.capacity = capacity;
+
+    return true;
+}
+
+// Squeeze out dead rows and fix up the per customer chains
+static void order_store_compact(void)
+{
+    uint32_t *p_new_row = malloc(sizeof(uint32_t) * g_orders.count);
+
+    // Compaction is only an optimisation, dead rows are harmless
+    if(!p_new_row)
+    {
+        return;
+    }
+
+    size_t out = 0;
+
+    for(size_t in = 0; in < g_orders.count; in++)
+    {
+        if(g_orders.p_customer_id[in] == CUSTOMER_NONE)
+        {
+            continue;
+        }
+
+        // A chain only points backwards and only at live rows
+        uint32_t prev = g_orders.p_prev_order[in];
+
+        p_new_row[in] = (uint32_t)out;
+        g_orders.p_order_id[out] = g_orders.p_order_id[in];
+        g_orders.p_quantity[out] = g_orders.p_quantity[in];
+        g_orders.p_amount_cents[out] = g_orders.p_amount_cents[in];
+        g_orders.p_customer_id[out] = g_orders.p_customer_id[in];
+        g_orders.p_prev_order[out] = (prev == ORDER_NONE) ? ORDER_NONE : p_new_row[prev];
+        out++;
+    }
+
+    for(size_t i = 0; i < g_orders.no_of_customers; i++)
+    {
+        customer_t *p_customer = g_orders.pp_customers[i];
+
+        if(p_customer && p_customer->last_order != ORDER_NONE)
+        {
+            p_customer->last_order = p_new_row[p_customer->last_order];
+        }
+    }
+
+    free(p_new_row);
+
+    g_orders.count = out;
+    g_orders.dead = 0;
+}
+
+static void order_store_release(uint32_t row)
+{
+    g_orders.p_customer_id[row] = CUSTOMER_NONE;
+    g_orders.p_amount_cents[row] = 0;
+    g_orders.p_quantity[row] = 0;
+    g_orders.dead++;
+
+    // Popping the newest order overall is the common case, just shrink
+    while(g_orders.count && g_orders.p_customer_id[g_orders.count - 1] == CUSTOMER_NONE)
+    {
+        g_orders.count--;
+        g_orders.dead--;
+    }
+
+    if(g_orders.dead > ORDER_STORE_INITIAL_CAPACITY && g_orders.dead > g_orders.count / 2)
+    {
+        order_store_compact();
+    }
+}
+
+static bool customer_register(customer_t *p_customer)
+{
+    // Ids are not reused so totals indexed by id stay stable
+    if(g_orders.no_of_customers == CUSTOMER_NONE)
+    {
+        return false;
+    }
+
+    if(g_orders.no_of_customers == g_orders.customers_capacity)
+    {
+        size_t capacity = g_orders.customers_capacity ? g_orders.customers_capacity * 2 : 64;
+        customer_t **pp_customers = realloc(g_orders.pp_customers, sizeof(customer_t *) * capacity);
+
+        if(!pp_customers)
+        {
+            return false;
+        }
+
+        g_orders.pp_customers = pp_customers;
+        g_orders.customers_capacity = capacity;
+    }
+
+    p_customer->id = (uint32_t)g_orders.no_of_customers;
+    g_orders.pp_customers[g_orders.no_of_customers++] = p_customer;
+
+    return true;
+}
+
+static void customer_drop_orders(customer_t *p_customer)
+{
+    while(p_customer->last_order != ORDER_NONE)
+    {
+        uint32_t row = p_customer->last_order;
+
+        p_customer->last_order = g_orders.p_prev_order[row];
+        order_store_release(row);
+    }
+
+    p_customer->no_of_orders = 0;
+}
 
 customer_t *customer_create(const char *p_name, const address_t *p_address)
 {
     assert(p_name);
     assert(p_address);
 
-    customer_t *p_customer = malloc(sizeof(customer_t));
+    customer_t *p_customer = calloc(1, sizeof(customer_t));
 
     if(p_customer)
     {
-        p_customer->name = p_name;
-        memcpy(&p_customer->address, p_address, sizeof(address_t));
-        p_customer->no_of_orders = 0;
+        p_customer->last_order = ORDER_NONE;
+
+        if(!customer_register(p_customer))
+        {
+            free(p_customer);
+            return NULL;
+        }
+
+        customer_init(p_customer, p_name, p_address);
+
+        if(!p_customer->p_name)
+        {
+            customer_destroy(p_customer);
+            p_customer = NULL;
+        }
     }
 
     return p_customer;
@@ -36,11 +259,10 @@ void customer_init(customer_t *p_customer, const char *p_name, const address_t *
     assert(p_name);
     assert(p_address);
 
-    p_customer->p_name = p_name;
-    p_customer->no_of_orders = 0;
-    memcpy(&p_customer->p_address, p_address, sizeof(address_t));
-    memset(orders, 0, sizeof(order_t) * MAX_NO_OF_ORDERS);
-
+    free(p_customer->p_name);
+    p_customer->p_name = copy_name(p_name);
+    memcpy(&p_customer->address, p_address, sizeof(address_t));
+    customer_drop_orders(p_customer);
 }
 
 void customer_destroy(customer_t *p_customer)
@@ -50,6 +272,9 @@ void customer_destroy(customer_t *p_customer)
         return;
     }
 
+    customer_drop_orders(p_customer);
+    g_orders.pp_customers[p_customer->id] = NULL;
+
     free(p_customer->p_name);
     free(p_customer);
 }
@@ -59,37 +284,214 @@ bool customer_place_order(customer_t *p_customer, const order_t *p_order)
     assert(p_customer);
     assert(p_order);
 
-    bool is_success = true;
+    // Check if the order store is full or not
+    if(g_orders.count == g_orders.capacity && !order_store_grow())
+    {
+        return false;
+    }
+
+    // Place the order
+    uint32_t row = (uint32_t)g_orders.count++;
+
+    g_orders.p_order_id[row] = p_order->order_id;
+    g_orders.p_quantity[row] = p_order->quantity;
+    g_orders.p_amount_cents[row] = p_order->amount_cents;
+    g_orders.p_customer_id[row] = p_customer->id;
+    g_orders.p_prev_order[row] = p_customer->last_order;
+
+    p_customer->last_order = row;
+
+    // Increase the no of orders
+    p_customer->no_of_orders++;
 
-    // Check if order array is full or not
-    if(p_customer->no_of_orders == MAX_NO_OF_ORDERS)
+    return true;
+}
+
+bool customer_pop_last_order(customer_t *p_customer, order_t *p_order)
+{
+    assert(p_customer);
+    assert(p_order);
+
+    if(!p_customer->no_of_orders)
     {
-        is_success = false;
+        return false;
     }
 
-    if(is_success)
+    // The row is gathered back from the columns before it is released
+    uint32_t row = p_customer->last_order;
+
+    p_order->order_id = g_orders.p_order_id[row];
+    p_order->quantity = g_orders.p_quantity[row];
+    p_order->amount_cents = g_orders.p_amount_cents[row];
+
+    p_customer->last_order = g_orders.p_prev_order[row];
+    p_customer->no_of_orders--;
+    order_store_release(row);
+
+    return true;
+}
+
+uint32_t customer_id(const customer_t *p_customer)
+{
+    assert(p_customer);
+
+    return p_customer->id;
+}
+
+size_t customer_no_of_orders(const customer_t *p_customer)
+{
+    assert(p_customer);
+
+    return p_customer->no_of_orders;
+}
+
+// Walks only this customer's rows, cheaper than a full column scan
+int64_t customer_total_amount(const customer_t *p_customer)
+{
+    assert(p_customer);
+
+    int64_t total = 0;
+
+    for(uint32_t row = p_customer->last_order; row != ORDER_NONE; row = g_orders.p_prev_order[row])
     {
-        // Place the order
-        memcpy(&p_customer->orders[p_customer->no_of_orders], p_order, sizeof(order_t));
+        total += g_orders.p_amount_cents[row];
+    }
+
+    return total;
+}
+
+size_t orders_count(void)
+{
+    return g_orders.count - g_orders.dead;
+}
+
+// The kernels below have an AVX2 path and a branch free scalar loop that the
+// compiler can vectorize for whatever instruction set it targets.
 
-        // Increase the no of orders
-        p_customer->no_of_orders++;
+int64_t orders_sum_amount(void)
+{
+    const int64_t *p_amount = g_orders.p_amount_cents;
+    size_t count = g_orders.count;
+    size_t i = 0;
+    int64_t total = 0;
+
+#if defined(__AVX2__)
+    // Two accumulators hide the add latency
+    __m256i sum0 = _mm256_setzero_si256();
+    __m256i sum1 = _mm256_setzero_si256();
+
+    for(; i + 8 <= count; i += 8)
+    {
+        sum0 = _mm256_add_epi64(sum0, _mm256_load_si256((const __m256i *)&p_amount[i]));
+        sum1 = _mm256_add_epi64(sum1, _mm256_load_si256((const __m256i *)&p_amount[i + 4]));
     }
 
-    return is_success;
+    int64_t lanes[4];
+    _mm256_storeu_si256((__m256i *)lanes, _mm256_add_epi64(sum0, sum1));
+    total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+
+    for(; i < count; i++)
+    {
+        total += p_amount[i];
+    }
+
+    return total;
 }
 
-order_t *customer_pop_last_order(customer_t *p_customer)
+#if defined(__AVX2__)
+// Bit n is set when row i + n is live and its amount is above min_cents
+static unsigned int amount_above_mask4(size_t i, __m256i min_cents, __m256i none)
 {
-    assert(p_customer);
+    __m256i amount = _mm256_load_si256((const __m256i *)&g_orders.p_amount_cents[i]);
+    __m256i owner = _mm256_cvtepu32_epi64(_mm_load_si128((const __m128i *)&g_orders.p_customer_id[i]));
+    __m256i above = _mm256_cmpgt_epi64(amount, min_cents);
+    __m256i match = _mm256_andnot_si256(_mm256_cmpeq_epi64(owner, none), above);
+
+    return (unsigned int)_mm256_movemask_pd(_mm256_castsi256_pd(match));
+}
+#endif
+
+size_t orders_count_amount_above(int64_t min_cents)
+{
+    size_t count = g_orders.count;
+    size_t i = 0;
+    size_t total = 0;
+
+#if defined(__AVX2__)
+    __m256i min_vec = _mm256_set1_epi64x(min_cents);
+    __m256i none = _mm256_set1_epi64x(CUSTOMER_NONE);
+
+    for(; i + 4 <= count; i += 4)
+    {
+        total += (size_t)__builtin_popcount(amount_above_mask4(i, min_vec, none));
+    }
+#endif
+
+    for(; i < count; i++)
+    {
+        total += (g_orders.p_customer_id[i] != CUSTOMER_NONE) & (g_orders.p_amount_cents[i] > min_cents);
+    }
+
+    return total;
+}
+
+// Writes the ids of matching orders in store order, returns how many were written
+size_t orders_filter_amount_above(int64_t min_cents, uint32_t *p_order_ids, size_t max_ids)
+{
+    assert(p_order_ids || !max_ids);
 
-    order_t *p_order = NULL;
+    size_t count = g_orders.count;
+    size_t i = 0;
+    size_t written = 0;
 
-    if(p_customer->no_of_orders)
+#if defined(__AVX2__)
+    __m256i min_vec = _mm256_set1_epi64x(min_cents);
+    __m256i none = _mm256_set1_epi64x(CUSTOMER_NONE);
+
+    for(; i + 4 <= count && written < max_ids; i += 4)
     {
-        p_customer->no_of_orders--;
-        p_order = &p_customer->orders[p_customer->no_of_orders];
+        unsigned int mask = amount_above_mask4(i, min_vec, none);
+
+        while(mask && written < max_ids)
+        {
+            p_order_ids[written++] = g_orders.p_order_id[i + (size_t)__builtin_ctz(mask)];
+            mask &= mask - 1;
+        }
     }
+#endif
 
-    return p_order;
-}
\ No newline at end of file
+    for(; i < count && written < max_ids; i++)
+    {
+        if(g_orders.p_customer_id[i] != CUSTOMER_NONE && g_orders.p_amount_cents[i] > min_cents)
+        {
+            p_order_ids[written++] = g_orders.p_order_id[i];
+        }
+    }
+
+    return written;
+}
+
+// Group by customer id in one pass, p_totals is indexed by customer_id().
+// Dead rows and customers beyond no_of_customers are skipped.
+void orders_total_per_customer(int64_t *p_totals, size_t no_of_customers)
+{
+    assert(p_totals || !no_of_customers);
+
+    if(!no_of_customers)
+    {
+        return;
+    }
+
+    memset(p_totals, 0, sizeof(int64_t) * no_of_customers);
+
+    for(size_t i = 0; i < g_orders.count; i++)
+    {
+        uint32_t owner = g_orders.p_customer_id[i];
+
+        if(owner < no_of_customers)
+        {
+            p_totals[owner] += g_orders.p_amount_cents[i];
+        }
+    }
+}
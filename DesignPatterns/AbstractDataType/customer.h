@@ -1,6 +1,22 @@
 #ifndef CUSTOMER_H
 #define CUSTOMER_H
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    char street[64];
+    char city[32];
+    char zip_code[16];
+} address_t;
+
+typedef struct {
+    uint32_t order_id;
+    uint32_t quantity;
+    int64_t amount_cents;
+} order_t;
+
 typedef struct customer_t customer_t; // Opaque type
 
 customer_t *customer_create(const char *p_name, const address_t *p_address);
@@ -9,10 +25,28 @@ void customer_destroy(customer_t *p_customer);
 
 void customer_init(customer_t *p_customer, const char *p_name, const address_t*p_address);
 
-void customer_place_order(customer_t *p_customer, const order_t *p_order);
+bool customer_place_order(customer_t *p_customer, const order_t *p_order);
+
+bool customer_pop_last_order(customer_t *p_customer, order_t *p_order);
+
+uint32_t customer_id(const customer_t *p_customer);
+
+size_t customer_no_of_orders(const customer_t *p_customer);
+
+int64_t customer_total_amount(const customer_t *p_customer);
+
+/* Aggregates over the orders of all customers */
+
+size_t orders_count(void);
+
+int64_t orders_sum_amount(void);
+
+size_t orders_count_amount_above(int64_t min_cents);
+
+size_t orders_filter_amount_above(int64_t min_cents, uint32_t *p_order_ids, size_t max_ids);
 
-order_t *customer_pop_last_order(customer_t *p_customer);
+void orders_total_per_customer(int64_t *p_totals, size_t no_of_customers);
 
 /* A lot of other related functions...*/
 
-#endif // CUSTOMER_H
\ No newline at end of file
+#endif // CUSTOMER_H